@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Frames of a damage set that changes by 1% of its rectangles each
+// frame, half erased and half inserted: the updates of a
+// dynamic_rectangle_partition against running rectangle_partition over
+// the whole set every frame.
+
+#include "workloads.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/dynamic_partition.hpp>
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+int main()
+{
+  std::cout << "workload,rectangles,changes_per_frame,dynamic_ns_per_frame,rebuild_ns_per_frame"
+               ",dynamic_fragments,rebuild_fragments" << std::endl;
+  std::size_t const frames = 20;
+  for (std::size_t n : {1000, 10000, 100000})
+  {
+    for (auto w : benchmarks::all_workloads)
+    {
+      std::size_t const changes = std::max<std::size_t> (n / 200, 1);
+      auto pool = benchmarks::make_workload (w, n + frames * changes);
+      std::vector<benchmarks::rectangle> current (pool.begin(), pool.begin() + n);
+      exp::algorithm::dynamic_rectangle_partition<benchmarks::rectangle> dynamic (current);
+      benchmarks::random_source random {5};
+
+      std::chrono::duration<double, std::nano> dynamic_time {}, rebuild_time {};
+      std::size_t rebuild_fragments = 0;
+      for (std::size_t frame = 0; frame != frames; ++frame)
+      {
+        auto now = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i != changes; ++i)
+        {
+          auto at = random () % current.size();
+          dynamic.erase (current[at]);
+          current[at] = current.back();
+          current.pop_back();
+        }
+        for (std::size_t i = 0; i != changes; ++i)
+        {
+          auto const& r = pool[n + frame * changes + i];
+          dynamic.insert (r);
+          current.push_back (r);
+        }
+        dynamic_time += std::chrono::steady_clock::now() - now;
+
+        now = std::chrono::steady_clock::now();
+        rebuild_fragments = exp::algorithm::rectangle_partition (current).size();
+        rebuild_time += std::chrono::steady_clock::now() - now;
+      }
+      std::cout << benchmarks::workload_name (w) << "," << n << "," << 2 * changes << ","
+                << dynamic_time.count() / frames << "," << rebuild_time.count() / frames << ","
+                << dynamic.fragments().size() << "," << rebuild_fragments << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Time and allocations to build the sorted event set of n intervals,
+// one interval at a time through interval_inserter against the bulk
+// builders of event_builder.hpp. The vector inserter is quadratic and
+// only runs for small n.
+
+#include "../support/test_support.hpp"
+
+#include "../support/allocation_counter.hpp"
+
+#include <algorithm/event_builder.hpp>
+#include <algorithm/btree_multiset.hpp>
+
+#include <set>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::event<interval> event;
+
+using support::next_random;
+
+std::vector<interval> random_intervals (std::size_t n)
+{
+  unsigned state = 7;
+  std::vector<interval> intervals;
+  for (std::size_t i = 0; i != n; ++i)
+  {
+    int begin = static_cast<int>(next_random (state) % (10 * n)) - static_cast<int>(5 * n);
+    intervals.push_back ({begin, begin + 1 + static_cast<int>(next_random (state) % 100)});
+  }
+  return intervals;
+}
+
+template <typename F>
+void measure (char const* name, std::vector<interval> const& intervals, F f)
+{
+  auto allocations = support::allocations().allocations;
+  auto now = std::chrono::steady_clock::now();
+  std::size_t events = f ();
+  std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+  allocations = support::allocations().allocations - allocations;
+  std::cout << name << "," << intervals.size() << "," << diff.count() / intervals.size()
+            << "," << static_cast<double>(allocations) / intervals.size() << "," << events << std::endl;
+}
+
+int main()
+{
+  std::cout << "builder,intervals,ns_per_interval,allocations_per_interval,events" << std::endl;
+  for (std::size_t n : {1000, 10000, 100000, 1000000})
+  {
+    auto intervals = random_intervals (n);
+    if (n <= 10000)
+      measure ("inserter_vector", intervals, [&]
+               {
+                 std::vector<event> v;
+                 std::copy (intervals.begin(), intervals.end(), exp::algorithm::interval_inserter<event> (v));
+                 return v.size();
+               });
+    measure ("inserter_multiset", intervals, [&]
+             {
+               std::multiset<event> set;
+               std::copy (intervals.begin(), intervals.end(), exp::algorithm::interval_inserter<event> (set));
+               return set.size();
+             });
+    measure ("stable_sort", intervals, [&]
+             {
+               std::vector<event> v;
+               for (auto&& i : intervals)
+               {
+                 v.push_back ({exp::algorithm::event_type::begin, i});
+                 v.push_back ({exp::algorithm::event_type::end, i});
+               }
+               std::stable_sort (v.begin(), v.end());
+               return v.size();
+             });
+    measure ("make_events", intervals, [&]
+             {
+               return exp::algorithm::make_events<event> (intervals.begin(), intervals.end()).size();
+             });
+    measure ("make_events_btree", intervals, [&]
+             {
+               exp::algorithm::btree_multiset<event> set;
+               exp::algorithm::insert_intervals<event> (set, intervals.begin(), intervals.end());
+               return set.size();
+             });
+  }
+  return 0;
+}
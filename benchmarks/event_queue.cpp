@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Event set throughput and memory, std::multiset against
+// btree_multiset. "sweep" inserts the begin events and then walks
+// them, inserting each end event ahead of the cursor like the
+// partition does. "partition" runs the whole rectangle_partition
+// sweep with each container as its event set. bytes_per_event is
+// what the container allocated while it held every event.
+
+#include "../support/test_support.hpp"
+
+#include "../support/allocation_counter.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/btree_multiset.hpp>
+
+#include <set>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+typedef exp::algorithm::detail::interval_n<rectangle, 0> interval0;
+typedef exp::algorithm::event<interval0> event;
+
+using support::next_random;
+
+std::vector<rectangle> random_rectangles (std::size_t n)
+{
+  unsigned state = 3;
+  int const side = 1000;
+  std::vector<rectangle> rects;
+  for (std::size_t i = 0; i != n; ++i)
+  {
+    int x = next_random (state) % side, y = next_random (state) % side;
+    rects.push_back ({{x, x + 1 + static_cast<int>(next_random (state) % 20)}
+                      , {y, y + 1 + static_cast<int>(next_random (state) % 20)}});
+  }
+  return rects;
+}
+
+template <typename Queue>
+void sweep (char const* name, std::vector<rectangle> const& rects)
+{
+  using exp::algorithm::event_type;
+  using exp::algorithm::event_api::is_begin_event;
+  using exp::algorithm::event_api::get_opposite_event;
+  auto now = std::chrono::steady_clock::now();
+  auto bytes = support::allocations().bytes;
+  std::size_t checksum = 0;
+  {
+    Queue set;
+    for (auto&& r : rects)
+      set.insert ({event_type::begin, {r}});
+    for (auto it = set.begin(); it != set.end(); ++it)
+    {
+      if (is_begin_event (*it))
+        set.insert (get_opposite_event (*it));
+      checksum += it->interval.rectangle.i1.first;
+    }
+    bytes = support::allocations().bytes - bytes;
+  }
+  std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+  std::size_t events = 2 * rects.size();
+  std::cout << "sweep," << name << "," << rects.size() << "," << diff.count() / events
+            << "," << static_cast<double>(bytes) / events << "," << checksum << std::endl;
+}
+
+template <typename Queue>
+void partition (char const* name, std::vector<rectangle> const& rects)
+{
+  auto now = std::chrono::steady_clock::now();
+  auto bytes = support::allocations().bytes;
+  auto result = exp::algorithm::detail::partition_sweep<Queue> (rects, std::allocator<char>(), exp::algorithm::null_trace{});
+  bytes = support::allocations().bytes - bytes;
+  std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+  std::size_t events = 2 * result.size();
+  std::cout << "partition," << name << "," << rects.size() << "," << diff.count() / events
+            << "," << static_cast<double>(bytes) / events << "," << result.size() << std::endl;
+}
+
+int main()
+{
+  std::cout << "pass,container,rectangles,ns_per_event,bytes_per_event,checksum" << std::endl;
+  for (std::size_t n : {1000, 10000, 100000, 1000000})
+  {
+    auto rects = random_rectangles (n);
+    sweep<std::multiset<event>> ("multiset", rects);
+    sweep<exp::algorithm::btree_multiset<event>> ("btree_multiset", rects);
+  }
+  for (std::size_t n : {1000, 10000, 30000})
+  {
+    auto rects = random_rectangles (n);
+    partition<std::multiset<event>> ("multiset", rects);
+    partition<exp::algorithm::btree_multiset<event>> ("btree_multiset", rects);
+  }
+  return 0;
+}
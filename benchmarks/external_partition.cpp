@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// external_rectangle_partition from a file to a file with an 8 MiB
+// budget, then rectangle_partition of the same rectangles in memory.
+// The external runs go first and in increasing size, so the peak
+// resident set after each one is its own; the input is generated in
+// pieces straight to the file to keep it out of the peak.
+
+#include "workloads.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/external_partition.hpp>
+
+#include <sys/resource.h>
+
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+long peak_rss_kb ()
+{
+  rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+std::size_t const sizes[] = {100000, 1000000};
+
+// the same rectangles make_workload would give, written in slices of
+// the plane so they never are all in memory
+std::string write_input (std::size_t n)
+{
+  auto path = std::filesystem::temp_directory_path().string() + "/external_partition_bench.in";
+  std::ofstream file (path, std::ios::binary);
+  std::size_t const slice = 100000;
+  for (std::size_t done = 0; done < n; done += slice)
+  {
+    auto rects = benchmarks::make_workload (benchmarks::workload::tile_grid, std::min (slice, n - done)
+                                            , static_cast<unsigned>(done / slice + 1));
+    for (auto& r : rects)
+    {
+      r.i0.first += static_cast<int>(done / slice) * 5000;
+      r.i0.second += static_cast<int>(done / slice) * 5000;
+    }
+    file.write (reinterpret_cast<char const*>(rects.data()), static_cast<std::streamsize>(rects.size() * sizeof (rects[0])));
+  }
+  return path;
+}
+
+}
+
+int main()
+{
+  std::cout << "mode,rectangles,ns_per_rectangle,fragments,runs,merge_passes,peak_sweep_events,peak_rss_kb" << std::endl;
+  auto output = std::filesystem::temp_directory_path().string() + "/external_partition_bench.out";
+  exp::algorithm::external_partition_options options;
+  options.memory_budget = std::size_t (8) << 20;
+  options.temporary_directory = std::filesystem::temp_directory_path().string();
+  for (auto n : sizes)
+  {
+    auto input = write_input (n);
+    auto now = std::chrono::steady_clock::now();
+    auto stats = exp::algorithm::external_rectangle_partition<benchmarks::rectangle> (input.c_str(), output.c_str(), options);
+    std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+    std::cout << "external," << n << "," << diff.count() / n << "," << stats.fragments << "," << stats.runs << ","
+              << stats.merge_passes << "," << stats.peak_sweep_events << "," << peak_rss_kb () << std::endl;
+    std::filesystem::remove (input);
+  }
+  std::filesystem::remove (output);
+
+  for (auto n : sizes)
+  {
+    auto input = write_input (n);
+    std::vector<benchmarks::rectangle> rects (n);
+    std::ifstream (input, std::ios::binary).read (reinterpret_cast<char*>(rects.data())
+                                                  , static_cast<std::streamsize>(n * sizeof (rects[0])));
+    std::filesystem::remove (input);
+    auto now = std::chrono::steady_clock::now();
+    auto fragments = exp::algorithm::rectangle_partition (std::move (rects));
+    std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+    std::cout << "memory," << n << "," << diff.count() / n << "," << fragments.size() << ",,,," << peak_rss_kb () << std::endl;
+  }
+  return 0;
+}
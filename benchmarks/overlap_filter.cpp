@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Time per candidate of the overlap filter of split_against_open: the
+// rectangles_overlap loop over open events against the kernels of
+// overlap_filter.hpp over the mirrored coordinates, for each level the
+// CPU supports.
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/overlap_filter.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+typedef exp::algorithm::event<exp::algorithm::detail::interval_n<rectangle, 0>> event;
+
+using support::next_random;
+
+template <typename F>
+void measure (char const* name, std::size_t open, std::size_t queries, F f)
+{
+  auto now = std::chrono::steady_clock::now();
+  std::size_t overlaps = f ();
+  std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+  std::cout << name << "," << open << "," << diff.count() / (open * queries) << "," << overlaps << std::endl;
+}
+
+int main()
+{
+  using exp::algorithm::simd_level;
+  std::cout << "filter,open,ns_per_candidate,overlaps" << std::endl;
+  for (std::size_t n : {16, 64, 256, 1024, 4096})
+  {
+    // tall thin open rectangles, as in a sweep, and short queries
+    unsigned state = 3;
+    std::vector<event> events;
+    exp::algorithm::soa_rectangles<int> soa;
+    for (std::size_t i = 0; i != n; ++i)
+    {
+      int y = static_cast<int>(next_random (state) % (16 * n));
+      rectangle r {{0, 1000}, {y, y + 1 + static_cast<int>(next_random (state) % 16)}};
+      events.push_back ({exp::algorithm::event_type::begin, {r}});
+      soa.push_back (r);
+    }
+    std::vector<rectangle> queries;
+    for (std::size_t i = 0; i != 1000; ++i)
+    {
+      int y = static_cast<int>(next_random (state) % (16 * n));
+      queries.push_back ({{500, 600}, {y, y + 8}});
+    }
+    std::size_t const rounds = 50000 / n + 1;
+
+    measure ("rectangles_overlap", n, rounds * queries.size(), [&]
+             {
+               std::size_t overlaps = 0;
+               for (std::size_t round = 0; round != rounds; ++round)
+                 for (auto&& q : queries)
+                   for (auto&& e : events)
+                     overlaps += exp::algorithm::detail::rectangles_overlap (q, e.interval.rectangle);
+               return overlaps;
+             });
+    char const* names[] = {"scalar", "sse4_2", "avx2", "avx512"};
+    for (auto level : {simd_level::scalar, simd_level::sse4_2, simd_level::avx2, simd_level::avx512})
+    {
+      if (exp::algorithm::detected_simd_level() < level)
+        break;
+      std::vector<std::uint64_t> masks;
+      measure (names[static_cast<int>(level)], n, rounds * queries.size(), [&]
+               {
+                 std::size_t overlaps = 0;
+                 for (std::size_t round = 0; round != rounds; ++round)
+                   for (auto&& q : queries)
+                   {
+                     exp::algorithm::overlap_masks (soa, q, masks, level);
+                     for (auto m : masks)
+                       overlaps += static_cast<std::size_t>(__builtin_popcountll (m));
+                   }
+                 return overlaps;
+               });
+    }
+  }
+  return 0;
+}
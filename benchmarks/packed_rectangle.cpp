@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// packed_rectangle against rectangles of int pairs: overlap tests and
+// splits of every pair in a window of rectangles, and
+// rectangle_partition, on damage of a 1920 by 1080 screen.
+
+#include "workloads.hpp"
+
+#include <algorithm/packed_rectangle.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+namespace {
+
+typedef exp::algorithm::packed_rectangle<> packed;
+
+// the workload scaled onto the screen
+std::vector<packed> screen (benchmarks::workload w, std::size_t n)
+{
+  auto rects = benchmarks::make_workload (w, n);
+  int max_x = 1, max_y = 1;
+  for (auto&& r : rects)
+  {
+    max_x = std::max (max_x, r.i0.second);
+    max_y = std::max (max_y, r.i1.second);
+  }
+  std::vector<packed> result;
+  for (auto&& r : rects)
+  {
+    auto x = [&] (int v) { return static_cast<std::uint16_t>(static_cast<long long>(std::max (v, 0)) * 1920 / max_x); };
+    auto y = [&] (int v) { return static_cast<std::uint16_t>(static_cast<long long>(std::max (v, 0)) * 1080 / max_y); };
+    result.push_back ({{x (r.i0.first), x (r.i0.second)}, {y (r.i1.first), y (r.i1.second)}});
+  }
+  return result;
+}
+
+template <typename Rectangle>
+double pairs_ns (std::vector<Rectangle> const& rects, std::size_t& checksum)
+{
+  std::size_t const window = 64;
+  auto now = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i + window <= rects.size(); i += window)
+    for (std::size_t j = i; j != i + window; ++j)
+      for (std::size_t k = i; k != i + window; ++k)
+        if (exp::algorithm::detail::rectangles_overlap (rects[j], rects[k]))
+          checksum += exp::algorithm::split_rectangle (rects[j], rects[k]).size();
+  std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+  return diff.count() / static_cast<double>(rects.size() / window * window * window);
+}
+
+template <typename Rectangle>
+double partition_ns (std::vector<Rectangle> const& rects, std::size_t& checksum)
+{
+  auto now = std::chrono::steady_clock::now();
+  checksum += exp::algorithm::rectangle_partition (rects).size();
+  std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+  return diff.count() / static_cast<double>(rects.size());
+}
+
+}
+
+int main()
+{
+  std::cout << "workload,rectangles,pair_ns,packed_pair_ns,partition_ns,packed_partition_ns" << std::endl;
+  for (auto w : benchmarks::all_workloads)
+  {
+    std::size_t const n = 20000;
+    auto packed_rects = screen (w, n);
+    std::vector<benchmarks::rectangle> rects;
+    for (auto&& r : packed_rects)
+      rects.push_back ({{r.i0.begin, r.i0.end}, {r.i1.begin, r.i1.end}});
+
+    std::size_t checksum = 0, packed_checksum = 0;
+    double pair = pairs_ns (rects, checksum), packed_pair = pairs_ns (packed_rects, packed_checksum);
+    double partition = partition_ns (rects, checksum), packed_partition = partition_ns (packed_rects, packed_checksum);
+    std::cout << benchmarks::workload_name (w) << "," << n << "," << pair << "," << packed_pair << ","
+              << partition << "," << packed_partition << (checksum == packed_checksum ? "" : ",mismatch") << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// rectangle_partition against parallel_rectangle_partition with 1 to
+// 8 threads. threads 0 is the single threaded partition.
+
+#include "workloads.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/parallel_partition.hpp>
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+template <typename F>
+void measure (benchmarks::workload w, std::size_t n, std::size_t threads, F f)
+{
+  auto rects = benchmarks::make_workload (w, n);
+  auto now = std::chrono::steady_clock::now();
+  auto fragments = f (rects);
+  std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+  std::cout << benchmarks::workload_name (w) << "," << n << "," << threads << ","
+            << exp::algorithm::detail::default_band_count (n) << "," << diff.count() / n
+            << "," << fragments.size() << std::endl;
+}
+
+int main()
+{
+  std::cout << "workload,rectangles,threads,bands,ns_per_rectangle,fragments" << std::endl;
+  for (auto w : {benchmarks::workload::tile_grid, benchmarks::workload::uniform, benchmarks::workload::thin_strips})
+  {
+    std::size_t const n = 200000;
+    measure (w, n, 0, [] (std::vector<benchmarks::rectangle> rects)
+                      { return exp::algorithm::rectangle_partition (std::move (rects)); });
+    for (std::size_t threads : {1, 2, 4, 8})
+      measure (w, n, threads, [threads] (std::vector<benchmarks::rectangle> rects)
+                              { return exp::algorithm::parallel_rectangle_partition (std::move (rects), threads); });
+  }
+  return 0;
+}
@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// A frame whose damage does not change, partitioned again and again:
+// rectangle_partition against a partition_cache hit, and a miss, where
+// two sets alternate in a cache that holds one.
+
+#include "workloads.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/partition_cache.hpp>
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+int main()
+{
+  std::cout << "workload,rectangles,partition_us,hit_us,miss_us" << std::endl;
+  for (std::size_t n : {100, 1000, 10000})
+  {
+    for (auto w : benchmarks::all_workloads)
+    {
+      auto rects = benchmarks::make_workload (w, n), other = benchmarks::make_workload (w, n, 2);
+      std::size_t const frames = 100000 / n;
+      std::size_t checksum = 0;
+
+      auto now = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i != frames; ++i)
+        checksum += exp::algorithm::rectangle_partition (rects).size();
+      std::chrono::duration<double, std::micro> partition = std::chrono::steady_clock::now() - now;
+
+      exp::algorithm::partition_cache<benchmarks::rectangle> cache (1);
+      cache.partition (rects);
+      now = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i != frames; ++i)
+        checksum += cache.partition (rects).size();
+      std::chrono::duration<double, std::micro> hit = std::chrono::steady_clock::now() - now;
+
+      now = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i != frames; ++i)
+        checksum += cache.partition (i % 2 ? rects : other).size();
+      std::chrono::duration<double, std::micro> miss = std::chrono::steady_clock::now() - now;
+
+      std::cout << benchmarks::workload_name (w) << "," << n << "," << partition.count() / frames << ","
+                << hit.count() / frames << "," << miss.count() / frames << (checksum == 0 ? " " : "") << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// One partition per frame, each frame a new damage set of the same
+// workload and size: rectangle_partition building everything again
+// against one partition_workspace and output kept for all frames. The
+// first frame, which grows the workspace, is not measured.
+
+#include "../support/allocation_counter.hpp"
+#include "workloads.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+int main()
+{
+  std::cout << "workload,rectangles,fresh_ns_per_frame,fresh_allocations_per_frame"
+               ",workspace_ns_per_frame,workspace_allocations_per_frame" << std::endl;
+  std::size_t const frames = 20;
+  for (std::size_t n : {1000, 10000})
+  {
+    for (auto w : benchmarks::all_workloads)
+    {
+      std::vector<std::vector<benchmarks::rectangle>> sets;
+      for (std::size_t frame = 0; frame != frames + 1; ++frame)
+        sets.push_back (benchmarks::make_workload (w, n, static_cast<unsigned>(frame + 1)));
+
+      exp::algorithm::partition_workspace<benchmarks::rectangle> workspace;
+      std::vector<benchmarks::rectangle> fragments;
+      exp::algorithm::rectangle_partition (workspace, sets[0], fragments);
+
+      std::chrono::duration<double, std::nano> fresh_time {}, workspace_time {};
+      std::size_t fresh_allocations = 0, workspace_allocations = 0;
+      for (std::size_t frame = 1; frame != frames + 1; ++frame)
+      {
+        auto allocations = support::allocations().allocations;
+        auto now = std::chrono::steady_clock::now();
+        auto fresh = exp::algorithm::rectangle_partition (sets[frame]);
+        fresh_time += std::chrono::steady_clock::now() - now;
+        fresh_allocations += support::allocations().allocations - allocations;
+
+        allocations = support::allocations().allocations;
+        now = std::chrono::steady_clock::now();
+        exp::algorithm::rectangle_partition (workspace, sets[frame], fragments);
+        workspace_time += std::chrono::steady_clock::now() - now;
+        workspace_allocations += support::allocations().allocations - allocations;
+        if (fresh.size() != fragments.size())
+        {
+          std::cerr << "fragment count differs" << std::endl;
+          return 1;
+        }
+      }
+      std::cout << benchmarks::workload_name (w) << "," << n << "," << fresh_time.count() / frames << ","
+                << static_cast<double>(fresh_allocations) / frames << "," << workspace_time.count() / frames
+                << "," << static_cast<double>(workspace_allocations) / frames << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Compares the single pass rectangle_partition with a sweep that
+// restarts from the leftmost event every time a rectangle is split,
+// which is how the partition used to work.
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+
+#include <set>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+// erases the open rectangle equal to r, found by a binary search for
+// its begin event and a walk over the equivalent ones
+template <typename Event0>
+void erase_rectangle (std::vector<Event0>& open_0, typename Event0::interval_type::rectangle_type const& r)
+{
+  auto it = std::lower_bound (open_0.begin(), open_0.end(), Event0 {exp::algorithm::event_type::begin, {r}});
+  while (it != open_0.end() && it->interval.rectangle != r)
+    ++it;
+  assert (it != open_0.end());
+  open_0.erase (it);
+}
+
+template <typename Container>
+Container restarting_partition (Container rects)
+{
+  typedef typename Container::value_type rectangle;
+  typedef exp::algorithm::detail::interval_n<rectangle, 0> interval0;
+  typedef exp::algorithm::event<interval0> event;
+  using exp::algorithm::event_type;
+  using exp::algorithm::event_api::is_begin_event;
+  using exp::algorithm::event_api::get_opposite_event;
+
+  std::multiset<event> set;
+  for (auto&& r : rects)
+    set.insert ({event_type::begin, {r}});
+
+  std::vector<event> open_0;
+  std::vector<rectangle> pieces, scratch;
+  bool restart = true;
+  while (restart)
+  {
+    restart = false;
+    open_0.clear();
+    std::multiset<event> sweep (set);
+    for (auto it = sweep.begin(); it != sweep.end() && !restart; ++it)
+    {
+      if (is_begin_event (*it))
+      {
+        auto r = it->interval.rectangle;
+        exp::algorithm::detail::split_against_open (open_0, r, pieces, scratch);
+        if (pieces.size() == 1 && pieces[0] == r)
+        {
+          open_0.insert (std::lower_bound (open_0.begin(), open_0.end(), *it), *it);
+          sweep.insert (get_opposite_event (*it));
+        }
+        else
+        {
+          auto range = set.equal_range (*it);
+          while (range.first->interval.rectangle != r)
+            ++range.first;
+          set.erase (range.first);
+          for (auto&& piece : pieces)
+            set.insert ({event_type::begin, {piece}});
+          restart = true;
+        }
+      }
+      else
+        erase_rectangle (open_0, it->interval.rectangle);
+    }
+  }
+
+  rects.clear();
+  for (auto&& e : set)
+    rects.push_back (e.interval.rectangle);
+  return rects;
+}
+
+using support::next_random;
+
+std::vector<rectangle> random_rectangles (std::size_t n)
+{
+  // keeps the average number of overlaps per rectangle constant
+  unsigned state = 7;
+  int side = 1;
+  while (static_cast<std::size_t>(side) * side < n)
+    ++side;
+  int const extent = side * 100;
+  std::vector<rectangle> rects (n);
+  for (auto&& r : rects)
+  {
+    int x = next_random (state) % extent, y = next_random (state) % extent;
+    int w = 20 + next_random (state) % 180, h = 20 + next_random (state) % 180;
+    r = {{x, x + w}, {y, y + h}};
+  }
+  return rects;
+}
+
+template <typename F>
+double measure (F f)
+{
+  auto now = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double, std::milli> diff = std::chrono::steady_clock::now() - now;
+  return diff.count();
+}
+
+int main()
+{
+  std::cout << "n,single_pass_ms,restarting_ms,fragments" << std::endl;
+  for (std::size_t n = 125; n <= 32000; n *= 2)
+  {
+    auto rects = random_rectangles (n);
+    std::vector<rectangle> single, restarting;
+    double single_ms = measure ([&] { single = exp::algorithm::rectangle_partition (rects); });
+    std::cout << n << "," << single_ms << ",";
+    // the restarting sweep gets too slow to wait for after this
+    if (n <= 1000)
+      std::cout << measure ([&] { restarting = restarting_partition (rects); });
+    std::cout << "," << single.size() << std::endl;
+  }
+  return 0;
+}
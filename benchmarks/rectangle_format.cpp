@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Size and speed of the rectangle set format, for every workload and
+// the fragments of its partition: bytes per rectangle against the 16
+// of an array, encoding, decoding into a std::vector and iterating a
+// rectangle_set_view without decoding into anything.
+
+#include "workloads.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/rectangle_format.hpp>
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+void measure (char const* workload, char const* set, std::vector<benchmarks::rectangle> const& rects)
+{
+  std::vector<unsigned char> bytes;
+  auto now = std::chrono::steady_clock::now();
+  exp::algorithm::encode_rectangles (rects, bytes);
+  std::chrono::duration<double, std::nano> encode = std::chrono::steady_clock::now() - now;
+
+  std::vector<benchmarks::rectangle> decoded;
+  now = std::chrono::steady_clock::now();
+  exp::algorithm::decode_rectangles (bytes.data(), bytes.size(), decoded);
+  std::chrono::duration<double, std::nano> decode = std::chrono::steady_clock::now() - now;
+
+  long checksum = 0;
+  now = std::chrono::steady_clock::now();
+  for (auto&& r : exp::algorithm::rectangle_set_view<benchmarks::rectangle> (bytes.data(), bytes.size()))
+    checksum += r.i0.second - r.i0.first;
+  std::chrono::duration<double, std::nano> iterate = std::chrono::steady_clock::now() - now;
+
+  double n = static_cast<double>(rects.size());
+  std::cout << workload << "," << set << "," << rects.size() << "," << static_cast<double>(bytes.size()) / n
+            << "," << encode.count() / n << "," << decode.count() / n << "," << iterate.count() / n
+            << "," << (checksum != 0) << std::endl;
+}
+
+}
+
+int main()
+{
+  std::cout << "workload,set,rectangles,bytes_per_rectangle,encode_ns,decode_ns,iterate_ns,checksum" << std::endl;
+  for (auto w : benchmarks::all_workloads)
+  {
+    auto rects = benchmarks::make_workload (w, 100000);
+    measure (benchmarks::workload_name (w), "input", rects);
+    measure (benchmarks::workload_name (w), "fragments", exp::algorithm::rectangle_partition (rects));
+  }
+  return 0;
+}
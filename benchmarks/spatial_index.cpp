@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Hit tests and window clips against the output of rectangle_partition:
+// a packed_rtree built over the fragments against a linear scan.
+// Points and 64 by 64 windows are spread over the bounds of the
+// fragments.
+
+#include "workloads.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/packed_rtree.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+int main()
+{
+  std::cout << "workload,rectangles,fragments,build_ns_per_fragment,locate_ns,scan_locate_ns"
+               ",window_ns,scan_window_ns,fragments_per_window" << std::endl;
+  std::size_t const queries = 20000, scan_queries = 500;
+  for (std::size_t n : {1000, 10000, 100000})
+  {
+    for (auto w : benchmarks::all_workloads)
+    {
+      auto fragments = exp::algorithm::rectangle_partition (benchmarks::make_workload (w, n));
+      int min_x = fragments[0].i0.first, max_x = fragments[0].i0.second
+        , min_y = fragments[0].i1.first, max_y = fragments[0].i1.second;
+      for (auto&& f : fragments)
+      {
+        min_x = std::min (min_x, f.i0.first);
+        max_x = std::max (max_x, f.i0.second);
+        min_y = std::min (min_y, f.i1.first);
+        max_y = std::max (max_y, f.i1.second);
+      }
+      benchmarks::random_source random {9};
+      std::vector<std::pair<int, int>> points (queries);
+      for (auto& p : points)
+        p = {min_x + static_cast<int>(random () % unsigned (max_x - min_x))
+             , min_y + static_cast<int>(random () % unsigned (max_y - min_y))};
+
+      auto now = std::chrono::steady_clock::now();
+      exp::algorithm::packed_rtree<benchmarks::rectangle> index (fragments);
+      std::chrono::duration<double, std::nano> build = std::chrono::steady_clock::now() - now;
+
+      std::size_t checksum = 0;
+      now = std::chrono::steady_clock::now();
+      for (auto&& p : points)
+        checksum += index.locate (p.first, p.second);
+      std::chrono::duration<double, std::nano> locate = std::chrono::steady_clock::now() - now;
+
+      now = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i != scan_queries; ++i)
+        checksum += static_cast<std::size_t>
+          (std::find_if (fragments.begin(), fragments.end()
+                         , [&] (auto&& f) { return f.i0.first <= points[i].first && points[i].first < f.i0.second
+                                                   && f.i1.first <= points[i].second && points[i].second < f.i1.second; })
+           - fragments.begin());
+      std::chrono::duration<double, std::nano> scan_locate = std::chrono::steady_clock::now() - now;
+
+      std::size_t hits = 0;
+      now = std::chrono::steady_clock::now();
+      for (auto&& p : points)
+        index.for_each_intersection ({{p.first, p.first + 64}, {p.second, p.second + 64}}, [&] (std::size_t) { ++hits; });
+      std::chrono::duration<double, std::nano> window = std::chrono::steady_clock::now() - now;
+
+      now = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i != scan_queries; ++i)
+      {
+        benchmarks::rectangle query {{points[i].first, points[i].first + 64}, {points[i].second, points[i].second + 64}};
+        for (auto&& f : fragments)
+          checksum += exp::algorithm::detail::rectangles_overlap (f, query);
+      }
+      std::chrono::duration<double, std::nano> scan_window = std::chrono::steady_clock::now() - now;
+
+      std::cout << benchmarks::workload_name (w) << "," << n << "," << fragments.size() << ","
+                << build.count() / fragments.size() << "," << locate.count() / queries << ","
+                << scan_locate.count() / scan_queries << "," << window.count() / queries << ","
+                << scan_window.count() / scan_queries << "," << static_cast<double>(hits) / queries
+                << (checksum == 0 ? " " : "") << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Allocations and time per split_rectangle call. The "vector" row
+// copies each result into a std::vector, which is what every split
+// cost when the kernels returned std::vector. The second table splits
+// batches of dividends by one divisor, one pair at a time against
+// split_batch.
+
+#include "../support/test_support.hpp"
+
+#include "../support/allocation_counter.hpp"
+
+#include <algorithm/rectangle.hpp>
+#include <algorithm/split_rectangles.hpp>
+#include <algorithm/split_batch.hpp>
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+std::vector<std::pair<rectangle, rectangle>> overlapping_pairs (std::size_t n)
+{
+  unsigned state = 11;
+  std::vector<std::pair<rectangle, rectangle>> pairs;
+  while (pairs.size() != n)
+  {
+    auto random_rectangle = [&]
+    {
+      int x = next_random (state) % 100, y = next_random (state) % 100;
+      return rectangle {{x, x + 1 + static_cast<int>(next_random (state) % 100)}
+                        , {y, y + 1 + static_cast<int>(next_random (state) % 100)}};
+    };
+    auto dividend = random_rectangle (), divisor = random_rectangle ();
+    if (exp::algorithm::detail::rectangles_overlap (dividend, divisor))
+      pairs.push_back ({dividend, divisor});
+  }
+  return pairs;
+}
+
+template <typename F>
+void measure (char const* name, std::vector<std::pair<rectangle, rectangle>> const& pairs, F f)
+{
+  std::size_t fragments = 0;
+  auto allocations = support::allocations().allocations;
+  auto now = std::chrono::steady_clock::now();
+  for (auto&& p : pairs)
+    fragments += f (p.first, p.second);
+  std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+  allocations = support::allocations().allocations - allocations;
+  std::cout << name << "," << pairs.size() << "," << diff.count() / pairs.size()
+            << "," << static_cast<double>(allocations) / pairs.size()
+            << "," << fragments << std::endl;
+}
+
+int main()
+{
+  auto pairs = overlapping_pairs (1000000);
+  std::cout << "api,splits,ns_per_split,allocations_per_split,fragments" << std::endl;
+  measure ("vector", pairs, [] (rectangle dividend, rectangle divisor)
+                            {
+                              auto fragments = exp::algorithm::split_rectangle (dividend, divisor);
+                              std::vector<rectangle> v (fragments.begin(), fragments.end());
+                              return v.size();
+                            });
+  measure ("split_result", pairs, [] (rectangle dividend, rectangle divisor)
+                                  {
+                                    return exp::algorithm::split_rectangle (dividend, divisor).size();
+                                  });
+  std::vector<rectangle> out;
+  out.reserve (4);
+  measure ("output_iterator", pairs, [&out] (rectangle dividend, rectangle divisor)
+                                     {
+                                       out.clear();
+                                       exp::algorithm::split_rectangle (dividend, divisor, std::back_inserter (out));
+                                       return out.size();
+                                     });
+
+  std::cout << "api,batch,ns_per_dividend,fragments" << std::endl;
+  for (std::size_t batch : {4, 16, 64, 256})
+  {
+    // dividends around one divisor, in every disposition
+    unsigned state = 13;
+    rectangle divisor {{40, 60}, {40, 60}};
+    std::vector<rectangle> dividends;
+    exp::algorithm::soa_rectangles<int> soa, out;
+    for (std::size_t i = 0; i != batch; ++i)
+    {
+      int x = 20 + next_random (state) % 40, y = 20 + next_random (state) % 40;
+      dividends.push_back ({{x, x + 1 + static_cast<int>(next_random (state) % 40)}
+                            , {y, y + 1 + static_cast<int>(next_random (state) % 40)}});
+      soa.push_back (dividends.back());
+    }
+    std::size_t const rounds = 4000000 / batch;
+    auto report = [&] (char const* name, std::chrono::duration<double, std::nano> diff, std::size_t fragments)
+    {
+      std::cout << name << "," << batch << "," << diff.count() / (rounds * batch) << "," << fragments << std::endl;
+    };
+
+    std::size_t fragments = 0;
+    std::vector<rectangle> pieces;
+    auto now = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round != rounds; ++round)
+    {
+      pieces.clear();
+      for (auto&& dividend : dividends)
+      {
+        if (exp::algorithm::detail::rectangles_overlap (dividend, divisor))
+          exp::algorithm::split_rectangle (dividend, divisor, std::back_inserter (pieces));
+        else
+          pieces.push_back (dividend);
+      }
+      fragments += pieces.size();
+    }
+    report ("per_pair", std::chrono::steady_clock::now() - now, fragments);
+
+    fragments = 0;
+    std::vector<unsigned char> codes;
+    now = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round != rounds; ++round)
+    {
+      exp::algorithm::split_batch (soa, divisor, out, codes);
+      fragments += out.size();
+    }
+    report ("split_batch", std::chrono::steady_clock::now() - now, fragments);
+  }
+  return 0;
+}
@@ -0,0 +1,286 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Runs scan_events, split_rectangle, rectangle_partition (with the
+// default allocator and over a monotonic buffer), coalesce_rectangles,
+// occlusion_partition, make_banded_region and measure_union over every
+// workload of workloads.hpp for n = 10 to 10^6 and prints one row per
+// run, as CSV or as JSON lines with --json. --max N stops at n = N.
+// scan_stream runs scan_intervals over the intervals of scan.
+//
+// Columns:
+//   events       scan: begin and end events of the x intervals
+//                scan_stream: the same, of intervals sorted by begin
+//                before the run
+//                split: split_rectangle calls, on pairs of
+//                overlapping rectangles close in x order
+//                partition, partition_pmr: events visited by the
+//                sweep
+//                coalesce: rectangles out of rectangle_partition
+//                occlusion: input rectangles
+//                region, measure: begin and end events of the y
+//                intervals
+//   ns_per_event wall time divided by events
+//   fragments    scan: begin events times the intervals open when they
+//                begin, split: fragments returned, partition: output
+//                rectangles, coalesce: rectangles left after merging,
+//                so 1 - fragments / events is the reduction,
+//                occlusion: visible fragments, region,
+//                measure: spans of all bands, scan_stream: as scan
+//   allocations  calls to operator new during the run, for
+//                partition_pmr the chunks of its monotonic buffer
+//   peak_rss_kb  peak resident set of the process so far, sizes run in
+//                increasing order so it follows the largest run
+
+#include "../support/allocation_counter.hpp"
+#include "workloads.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/coalesce.hpp>
+#include <algorithm/occlusion.hpp>
+#include <algorithm/banded_region.hpp>
+#include <algorithm/union_measure.hpp>
+#include <algorithm/split_rectangles.hpp>
+#include <algorithm/event_scan.hpp>
+#include <algorithm/event_builder.hpp>
+#include <algorithm/btree_multiset.hpp>
+
+#include <sys/resource.h>
+
+#include <memory_resource>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+struct result
+{
+  std::size_t events;
+  std::size_t fragments;
+};
+
+struct count_events
+{
+  template <typename... Args>
+  void operator()(exp::algorithm::trace_point point, Args const&...)
+  {
+    if (point == exp::algorithm::trace_point::event)
+      ++events;
+  }
+
+  std::size_t events = 0;
+};
+
+long peak_rss_kb ()
+{
+  rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// Each operation has an untimed prepare step and a timed run step
+
+std::vector<exp::algorithm::event<benchmarks::interval>> prepare_scan (std::vector<benchmarks::rectangle> const& rects)
+{
+  typedef exp::algorithm::event<benchmarks::interval> event;
+  std::vector<benchmarks::interval> intervals;
+  intervals.reserve (rects.size());
+  for (auto&& r : rects)
+    intervals.push_back (r.i0);
+  return exp::algorithm::make_events<event> (intervals.begin(), intervals.end());
+}
+
+result scan (std::vector<exp::algorithm::event<benchmarks::interval>> const& events)
+{
+  typedef exp::algorithm::event<benchmarks::interval> event;
+  std::size_t overlaps = 0;
+  exp::algorithm::btree_multiset<event> actives;
+  exp::algorithm::scan_events (actives, events
+                               , [&] (auto&& actives, event const&) { overlaps += actives.size() - 1; }
+                               , [] (auto&&, event const&) {});
+  return {events.size(), overlaps};
+}
+
+std::vector<benchmarks::interval> prepare_scan_stream (std::vector<benchmarks::rectangle> const& rects)
+{
+  std::vector<benchmarks::interval> intervals;
+  intervals.reserve (rects.size());
+  for (auto&& r : rects)
+    intervals.push_back (r.i0);
+  std::sort (intervals.begin(), intervals.end());
+  return intervals;
+}
+
+result scan_stream (std::vector<benchmarks::interval> const& intervals)
+{
+  typedef exp::algorithm::event<benchmarks::interval> event;
+  std::size_t overlaps = 0;
+  exp::algorithm::btree_multiset<event> actives;
+  exp::algorithm::scan_intervals<event> (actives, intervals.begin(), intervals.end()
+                                         , [&] (auto&& actives, event const&) { overlaps += actives.size() - 1; }
+                                         , [] (auto&&, event const&) {});
+  return {2 * intervals.size(), overlaps};
+}
+
+// pairs of rectangles that overlap, each one with up to four of the
+// rectangles that follow it in x order
+std::vector<std::pair<benchmarks::rectangle, benchmarks::rectangle>>
+  prepare_split (std::vector<benchmarks::rectangle> rects)
+{
+  std::sort (rects.begin(), rects.end(), [] (auto&& l, auto&& r) { return l.i0.first < r.i0.first; });
+  std::vector<std::pair<benchmarks::rectangle, benchmarks::rectangle>> pairs;
+  for (std::size_t i = 0; i != rects.size(); ++i)
+  {
+    std::size_t found = 0;
+    for (std::size_t j = i + 1; j != rects.size() && found != 4 && rects[j].i0.first < rects[i].i0.second; ++j)
+    {
+      if (exp::algorithm::detail::rectangles_overlap (rects[i], rects[j]))
+      {
+        pairs.push_back ({rects[i], rects[j]});
+        ++found;
+      }
+    }
+  }
+  return pairs;
+}
+
+result split (std::vector<std::pair<benchmarks::rectangle, benchmarks::rectangle>> const& pairs)
+{
+  std::size_t fragments = 0;
+  for (auto&& p : pairs)
+    fragments += exp::algorithm::split_rectangle (p.first, p.second).size();
+  return {pairs.size(), fragments};
+}
+
+std::vector<benchmarks::rectangle> prepare_partition (std::vector<benchmarks::rectangle> rects)
+{
+  return rects;
+}
+
+result partition (std::vector<benchmarks::rectangle> const& rects)
+{
+  count_events counter;
+  auto fragments = exp::algorithm::rectangle_partition (rects, counter);
+  return {counter.events, fragments.size()};
+}
+
+// the temporaries and the output all come from one monotonic buffer
+// dropped at once, as a frame allocator would
+result partition_pmr (std::vector<benchmarks::rectangle> const& rects)
+{
+  count_events counter;
+  std::pmr::monotonic_buffer_resource frame;
+  std::pmr::vector<benchmarks::rectangle> input (rects.begin(), rects.end(), &frame);
+  auto fragments = exp::algorithm::rectangle_partition
+    (std::allocator_arg, std::pmr::polymorphic_allocator<char> (&frame), std::move (input), counter);
+  return {counter.events, fragments.size()};
+}
+
+std::vector<benchmarks::rectangle> prepare_coalesce (std::vector<benchmarks::rectangle> rects)
+{
+  return exp::algorithm::rectangle_partition (std::move (rects));
+}
+
+result coalesce (std::vector<benchmarks::rectangle> const& fragments)
+{
+  return {fragments.size(), exp::algorithm::coalesce_rectangles (fragments).size()};
+}
+
+// every rectangle gets a random depth
+std::pair<std::vector<benchmarks::rectangle>, std::vector<unsigned>>
+  prepare_occlusion (std::vector<benchmarks::rectangle> rects)
+{
+  benchmarks::random_source random {3};
+  std::vector<unsigned> z (rects.size());
+  for (auto& d : z)
+    d = random () % 64;
+  return {std::move (rects), std::move (z)};
+}
+
+result occlusion (std::pair<std::vector<benchmarks::rectangle>, std::vector<unsigned>> const& layers)
+{
+  auto visible = exp::algorithm::occlusion_partition (layers.first, layers.second);
+  return {layers.first.size(), visible.fragments.size()};
+}
+
+result region (std::vector<benchmarks::rectangle> const& rects)
+{
+  auto banded = exp::algorithm::make_banded_region (rects);
+  return {2 * rects.size(), banded.spans().size()};
+}
+
+result measure (std::vector<benchmarks::rectangle> const& rects)
+{
+  return {2 * rects.size(), exp::algorithm::measure_union (rects).fragments};
+}
+
+template <typename Prepare, typename F>
+void run (bool json, benchmarks::workload w, char const* operation, std::size_t n, Prepare prepare, F f)
+{
+  auto input = prepare (benchmarks::make_workload (w, n));
+  auto allocations = support::allocations().allocations;
+  auto now = std::chrono::steady_clock::now();
+  result r = f (input);
+  std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - now;
+  allocations = support::allocations().allocations - allocations;
+  double ns_per_event = r.events ? diff.count() / r.events : 0;
+
+  if (json)
+    std::cout << "{\"workload\":\"" << benchmarks::workload_name (w) << "\",\"operation\":\"" << operation
+              << "\",\"n\":" << n << ",\"events\":" << r.events << ",\"ns_per_event\":" << ns_per_event
+              << ",\"fragments\":" << r.fragments << ",\"allocations\":" << allocations
+              << ",\"peak_rss_kb\":" << peak_rss_kb () << "}" << std::endl;
+  else
+    std::cout << benchmarks::workload_name (w) << "," << operation << "," << n << "," << r.events
+              << "," << ns_per_event << "," << r.fragments << "," << allocations
+              << "," << peak_rss_kb () << std::endl;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+  bool json = false;
+  std::size_t max = 1000000;
+  for (int i = 1; i != argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--json")
+      json = true;
+    else if (arg == "--max" && i + 1 != argc)
+      max = std::strtoul (argv[++i], nullptr, 10);
+    else
+    {
+      std::cerr << "usage: " << argv[0] << " [--json] [--max N]" << std::endl;
+      return 1;
+    }
+  }
+
+  if (!json)
+    std::cout << "workload,operation,n,events,ns_per_event,fragments,allocations,peak_rss_kb" << std::endl;
+  for (std::size_t n = 10; n <= max; n *= 10)
+  {
+    for (auto w : benchmarks::all_workloads)
+    {
+      run (json, w, "scan", n, prepare_scan, scan);
+      run (json, w, "scan_stream", n, prepare_scan_stream, scan_stream);
+      run (json, w, "split", n, prepare_split, split);
+      run (json, w, "partition", n, prepare_partition, partition);
+      run (json, w, "partition_pmr", n, prepare_partition, partition_pmr);
+      run (json, w, "coalesce", n, prepare_coalesce, coalesce);
+      run (json, w, "occlusion", n, prepare_occlusion, occlusion);
+      run (json, w, "region", n, prepare_partition, region);
+      run (json, w, "measure", n, prepare_partition, measure);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BENCHMARKS_WORKLOADS_HPP
+#define BENCHMARKS_WORKLOADS_HPP
+
+// Rectangle workloads for the benchmarks. Every workload grows its
+// area with n so the number of rectangles overlapping any given one
+// stays about the same, and sizes can be compared across n. They are
+// deterministic for a given seed.
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/rectangle.hpp>
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace benchmarks {
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+enum class workload
+{
+  uniform, clustered, nested_windows, tile_grid, thin_strips
+};
+
+constexpr workload all_workloads[] = {workload::uniform, workload::clustered, workload::nested_windows
+                                      , workload::tile_grid, workload::thin_strips};
+
+inline char const* workload_name (workload w)
+{
+  switch (w)
+  {
+  case workload::uniform:
+    return "uniform";
+  case workload::clustered:
+    return "clustered";
+  case workload::nested_windows:
+    return "nested_windows";
+  case workload::tile_grid:
+    return "tile_grid";
+  case workload::thin_strips:
+    return "thin_strips";
+  default:
+    return "unknown";
+  }
+}
+
+struct random_source
+{
+  unsigned operator()() { return support::next_random (state); }
+  // uniform in [0, n)
+  int operator()(int n)
+  {
+    return n > 0 ? static_cast<int>((*this)() % static_cast<unsigned>(n)) : 0;
+  }
+
+  unsigned state;
+};
+
+namespace detail {
+
+// about sqrt(n) * scale, the side of a square holding n rectangles
+inline int side (std::size_t n, int scale)
+{
+  int s = 1;
+  while (static_cast<std::size_t>(s) * s < n)
+    ++s;
+  return s * scale;
+}
+
+inline rectangle make_rectangle (int x, int y, int width, int height)
+{
+  return {{x, x + width}, {y, y + height}};
+}
+
+// Sizes from 1 to 64 anywhere in the area
+inline std::vector<rectangle> uniform (std::size_t n, random_source& random)
+{
+  int const area = side (n, 32);
+  std::vector<rectangle> rects;
+  for (std::size_t i = 0; i != n; ++i)
+    rects.push_back (make_rectangle (random (area), random (area), 1 + random (64), 1 + random (64)));
+  return rects;
+}
+
+// Groups of about 64 rectangles around random centers, denser in the
+// middle, with empty space between groups
+inline std::vector<rectangle> clustered (std::size_t n, random_source& random)
+{
+  int const area = side (n, 48);
+  std::vector<rectangle> rects;
+  int cx = 0, cy = 0;
+  for (std::size_t i = 0; i != n; ++i)
+  {
+    if (i % 64 == 0)
+    {
+      cx = random (area);
+      cy = random (area);
+    }
+    int dx = random (128) + random (128) - 128, dy = random (128) + random (128) - 128;
+    rects.push_back (make_rectangle (cx + dx, cy + dy, 1 + random (48), 1 + random (48)));
+  }
+  return rects;
+}
+
+// Windows on a screen, each with panels inside it and buttons inside
+// the panels. Windows overlap each other, children are always nested
+// in their parent.
+inline std::vector<rectangle> nested_windows (std::size_t n, random_source& random)
+{
+  int const area = side (n, 80);
+  std::vector<rectangle> rects;
+  while (rects.size() < n)
+  {
+    auto window = make_rectangle (random (area), random (area), 200 + random (400), 150 + random (300));
+    rects.push_back (window);
+    int panels = 1 + random (4);
+    for (int p = 0; p != panels && rects.size() < n; ++p)
+    {
+      int w = (window.i0.second - window.i0.first) / 2, h = (window.i1.second - window.i1.first) / 2;
+      auto panel = make_rectangle (window.i0.first + 4 + random (w), window.i1.first + 24 + random (h - 24)
+                                   , 1 + random (w - 8), 1 + random (h - 8));
+      rects.push_back (panel);
+      int buttons = random (8);
+      for (int b = 0; b != buttons && rects.size() < n; ++b)
+      {
+        int pw = panel.i0.second - panel.i0.first, ph = panel.i1.second - panel.i1.first;
+        int bw = 1 + random (pw / 2 + 1), bh = 1 + random (ph / 2 + 1);
+        rects.push_back (make_rectangle (panel.i0.first + random (pw - bw + 1), panel.i1.first + random (ph - bh + 1)
+                                         , bw, bh));
+      }
+    }
+  }
+  return rects;
+}
+
+// Map tiles of 16x16 side by side, touching but not overlapping, with
+// one tile in eight grown over its neighbours like a highlight
+inline std::vector<rectangle> tile_grid (std::size_t n, random_source& random)
+{
+  int const columns = side (n, 1);
+  std::vector<rectangle> rects;
+  for (std::size_t i = 0; i != n; ++i)
+  {
+    int x = static_cast<int>(i % columns) * 16, y = static_cast<int>(i / columns) * 16;
+    if (random (8) == 0)
+      rects.push_back (make_rectangle (x - 4, y - 4, 24, 24));
+    else
+      rects.push_back (make_rectangle (x, y, 16, 16));
+  }
+  return rects;
+}
+
+// Horizontal and vertical strips one or two units thick, like table
+// borders and grid lines, crossing each other
+inline std::vector<rectangle> thin_strips (std::size_t n, random_source& random)
+{
+  int const area = side (n, 64);
+  std::vector<rectangle> rects;
+  for (std::size_t i = 0; i != n; ++i)
+  {
+    int length = 64 + random (448), thickness = 1 + random (2);
+    if (i % 2 == 0)
+      rects.push_back (make_rectangle (random (area), random (area), length, thickness));
+    else
+      rects.push_back (make_rectangle (random (area), random (area), thickness, length));
+  }
+  return rects;
+}
+
+}
+
+inline std::vector<rectangle> make_workload (workload w, std::size_t n, unsigned seed = 1)
+{
+  random_source random {seed};
+  switch (w)
+  {
+  case workload::uniform:
+    return detail::uniform (n, random);
+  case workload::clustered:
+    return detail::clustered (n, random);
+  case workload::nested_windows:
+    return detail::nested_windows (n, random);
+  case workload::tile_grid:
+    return detail::tile_grid (n, random);
+  case workload::thin_strips:
+  default:
+    return detail::thin_strips (n, random);
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,267 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_ACTIVE_SET_HPP
+#define ALGORITHM_ACTIVE_SET_HPP
+
+#include <algorithm/btree_multiset.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <set>
+#include <cassert>
+
+namespace exp { namespace algorithm {
+
+// The active set is the container scan_events keeps the open events
+// in. It is passed to the callbacks, which iterate it in event order,
+// so it must be a bidirectional range sorted by event. scan_events
+// changes it only through insert_active and erase_active, which can be
+// overloaded for other containers.
+namespace active_set_api {
+
+// Events arrive sorted, so this is a push_back. Erasing is linear.
+template <typename Event, typename Allocator>
+void insert_active (std::vector<Event, Allocator>& actives, Event const& e)
+{
+  if (actives.empty() || !(e < actives.back()))
+    actives.push_back (e);
+  else
+    actives.insert (std::upper_bound (actives.begin(), actives.end(), e), e);
+}
+
+template <typename Event, typename Allocator>
+bool erase_active (std::vector<Event, Allocator>& actives, Event const& e)
+{
+  auto it = std::lower_bound (actives.begin(), actives.end(), e);
+  while (it != actives.end() && *it != e)
+    ++it;
+  if (it == actives.end())
+    return false;
+  actives.erase (it);
+  return true;
+}
+
+// Balanced tree, logarithmic insert and erase. Erasing walks the
+// events equivalent to e looking for the one equal to it.
+template <typename Event, typename Compare, typename Allocator>
+void insert_active (std::multiset<Event, Compare, Allocator>& actives, Event const& e)
+{
+  actives.insert (actives.end(), e);
+}
+
+template <typename Event, typename Compare, typename Allocator>
+bool erase_active (std::multiset<Event, Compare, Allocator>& actives, Event const& e)
+{
+  auto range = actives.equal_range (e);
+  while (range.first != range.second && *range.first != e)
+    ++range.first;
+  if (range.first == range.second)
+    return false;
+  actives.erase (range.first);
+  return true;
+}
+
+template <typename Event, typename Compare, typename Allocator, std::size_t NodeBytes>
+void insert_active (btree_multiset<Event, Compare, Allocator, NodeBytes>& actives, Event const& e)
+{
+  actives.insert (e);
+}
+
+template <typename Event, typename Compare, typename Allocator, std::size_t NodeBytes>
+bool erase_active (btree_multiset<Event, Compare, Allocator, NodeBytes>& actives, Event const& e)
+{
+  auto range = actives.equal_range (e);
+  while (range.first != range.second && *range.first != e)
+    ++range.first;
+  if (range.first == range.second)
+    return false;
+  actives.erase (range.first);
+  return true;
+}
+
+// Any other container provides insert_active and erase_active members
+template <typename ActiveContainer, typename Event>
+void insert_active (ActiveContainer& actives, Event const& e)
+{
+  actives.insert_active (e);
+}
+
+template <typename ActiveContainer, typename Event>
+bool erase_active (ActiveContainer& actives, Event const& e)
+{
+  return actives.erase_active (e);
+}
+
+}
+
+// Sorted vector where erased events are only marked dead and removed
+// all at once when they outnumber the live ones. Insert at the end and
+// erase are amortized logarithmic, and iteration stays contiguous.
+template <typename Event>
+struct tombstone_active_set
+{
+  typedef Event value_type;
+  typedef Event const& reference;
+  typedef Event const& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+private:
+  struct entry
+  {
+    Event event;
+    bool alive;
+  };
+
+public:
+  class const_iterator
+  {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Event value_type;
+    typedef Event const& reference;
+    typedef Event const* pointer;
+    typedef std::ptrdiff_t difference_type;
+
+    const_iterator () = default;
+    const_iterator (entry const* current, entry const* first, entry const* last)
+      : current (current), first (first), last (last)
+    {
+      skip_forward ();
+    }
+
+    reference operator*() const { return current->event; }
+    pointer operator->() const { return &current->event; }
+
+    const_iterator& operator++()
+    {
+      ++current;
+      skip_forward ();
+      return *this;
+    }
+    const_iterator operator++(int)
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    const_iterator& operator--()
+    {
+      do
+        --current;
+      while (current != first && !current->alive);
+      return *this;
+    }
+    const_iterator operator--(int)
+    {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    bool operator==(const_iterator const& other) const { return current == other.current; }
+    bool operator!=(const_iterator const& other) const { return current != other.current; }
+
+  private:
+    void skip_forward ()
+    {
+      while (current != last && !current->alive)
+        ++current;
+    }
+
+    entry const* current = nullptr;
+    entry const* first = nullptr;
+    entry const* last = nullptr;
+  };
+  typedef const_iterator iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef const_reverse_iterator reverse_iterator;
+
+  const_iterator begin () const { return {entries.data(), entries.data(), entries.data() + entries.size()}; }
+  const_iterator end () const
+  {
+    auto last = entries.data() + entries.size();
+    return {last, entries.data(), last};
+  }
+  const_reverse_iterator rbegin () const { return const_reverse_iterator (end()); }
+  const_reverse_iterator rend () const { return const_reverse_iterator (begin()); }
+
+  size_type size () const { return live; }
+  bool empty () const { return live == 0; }
+  void clear ()
+  {
+    entries.clear();
+    live = 0;
+  }
+
+  void insert_active (Event const& e)
+  {
+    if (entries.empty() || !(e < entries.back().event))
+      entries.push_back ({e, true});
+    else
+      entries.insert (std::upper_bound (entries.begin(), entries.end(), e
+                                        , [] (Event const& l, entry const& r) { return l < r.event; })
+                      , entry{e, true});
+    ++live;
+  }
+
+  bool erase_active (Event const& e)
+  {
+    auto it = std::lower_bound (entries.begin(), entries.end(), e
+                                , [] (entry const& l, Event const& r) { return l.event < r; });
+    while (it != entries.end() && !(e < it->event) && !(it->alive && it->event == e))
+      ++it;
+    if (it == entries.end() || e < it->event)
+      return false;
+    it->alive = false;
+    --live;
+    if (entries.size() - live > live)
+      compact ();
+    return true;
+  }
+
+private:
+  void compact ()
+  {
+    entries.erase (std::remove_if (entries.begin(), entries.end(), [] (entry const& e) { return !e.alive; })
+                   , entries.end());
+    assert (entries.size() == live);
+  }
+
+  std::vector<entry> entries;
+  size_type live = 0;
+};
+
+// Keeps only the number of open events, for sweeps whose callbacks
+// never look at the active set. It is not a range.
+template <typename Event>
+struct counting_active_set
+{
+  typedef Event value_type;
+  typedef std::size_t size_type;
+
+  void insert_active (Event const&) { ++count; }
+  bool erase_active (Event const&)
+  {
+    assert (count != 0);
+    --count;
+    return true;
+  }
+
+  size_type size () const { return count; }
+  bool empty () const { return count == 0; }
+
+private:
+  size_type count = 0;
+};
+
+} }
+
+#endif
@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_BANDED_REGION_HPP
+#define ALGORITHM_BANDED_REGION_HPP
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/split_rectangles.hpp>
+#include <algorithm/event_scan.hpp>
+#include <algorithm/event_builder.hpp>
+#include <algorithm/active_set.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace exp { namespace algorithm {
+
+// The area covered by a set of rectangles as y bands, each one holding
+// sorted disjoint x spans. The form is canonical: spans in a band
+// never touch, bands have at least one span and two bands that touch
+// vertically never have the same spans, they are a single band. Equal
+// areas give equal regions, so comparing them is linear. Spans of all
+// bands are kept in one vector.
+template <typename Position>
+class banded_region
+{
+public:
+  typedef Position position_type;
+  typedef std::pair<Position, Position> span;
+
+  struct band
+  {
+    Position y1, y2;
+    // spans of the band in spans()
+    std::size_t first, last;
+
+    bool operator==(band const& other) const
+    {
+      return y1 == other.y1 && y2 == other.y2 && first == other.first && last == other.last;
+    }
+  };
+
+  std::vector<band> const& bands () const { return bands_; }
+  std::vector<span> const& spans () const { return spans_; }
+  span const* begin (band const& b) const { return spans_.data() + b.first; }
+  span const* end (band const& b) const { return spans_.data() + b.last; }
+
+  bool empty () const { return bands_.empty(); }
+
+  auto area () const
+  {
+    decltype (Position() * Position()) total {};
+    for (auto&& b : bands_)
+      for (auto s = begin (b); s != end (b); ++s)
+        total += (s->second - s->first) * (b.y2 - b.y1);
+    return total;
+  }
+
+  // calls f (x1, x2, y1, y2) for every span of every band
+  template <typename F>
+  void for_each_rectangle (F&& f) const
+  {
+    for (auto&& b : bands_)
+      for (auto s = begin (b); s != end (b); ++s)
+        f (s->first, s->second, b.y1, b.y2);
+  }
+
+  // Adds the band [y1, y2) with the sorted disjoint spans already at
+  // the end of spans(), after the spans of the last band. Merges it
+  // into the last band when they touch and have the same spans.
+  void close_band (Position y1, Position y2)
+  {
+    std::size_t first = bands_.empty() ? 0 : bands_.back().last;
+    if (first == spans_.size())
+      return;
+    if (!bands_.empty())
+    {
+      auto& last = bands_.back();
+      if (last.y2 == y1 && last.last - last.first == spans_.size() - first
+          && std::equal (spans_.begin() + first, spans_.end(), spans_.begin() + last.first))
+      {
+        last.y2 = y2;
+        spans_.resize (first);
+        return;
+      }
+    }
+    bands_.push_back ({y1, y2, first, spans_.size()});
+  }
+
+  // Appends x spans, sorted by x1, for the next band. Overlapping or
+  // touching spans are joined.
+  void add_span (Position x1, Position x2)
+  {
+    std::size_t first = bands_.empty() ? 0 : bands_.back().last;
+    if (spans_.size() != first && !(spans_.back().second < x1))
+      spans_.back().second = std::max (spans_.back().second, x2);
+    else
+      spans_.push_back ({x1, x2});
+  }
+
+  void clear ()
+  {
+    bands_.clear();
+    spans_.clear();
+  }
+
+  friend bool operator==(banded_region const& l, banded_region const& r)
+  {
+    return l.bands_ == r.bands_ && l.spans_ == r.spans_;
+  }
+  friend bool operator!=(banded_region const& l, banded_region const& r)
+  {
+    return !(l == r);
+  }
+
+private:
+  std::vector<band> bands_;
+  std::vector<span> spans_;
+};
+
+// The region covered by rects. Runs scan_events over dim-1: every time
+// the sweep reaches a new y the x intervals of the rectangles open
+// until then are joined into the spans of the band that ends there.
+// The x intervals are kept sorted as rectangles open and close, so a
+// band costs one pass over them.
+template <typename Container>
+banded_region<typename detail::rectangle_position<typename Container::value_type>::type>
+  make_banded_region (Container const& rects)
+{
+  typedef typename Container::value_type rectangle;
+  typedef typename detail::rectangle_position<rectangle>::type position;
+  typedef event<detail::interval_n<rectangle, 1>> event1;
+  using algorithm::event_api::get_position;
+
+  std::vector<event1> events;
+  events.reserve (2 * rects.size());
+  for (auto&& r : rects)
+  {
+    if (detail::rget_x1 (r) < detail::rget_x2 (r) && detail::rget_y1 (r) < detail::rget_y2 (r))
+    {
+      events.push_back ({event_type::begin, {r}});
+      events.push_back ({event_type::end, {r}});
+    }
+  }
+  algorithm::sort_events (events);
+
+  banded_region<position> region;
+  // x intervals of the open rectangles sorted by x, updated after the
+  // band that ends at the event was added
+  std::vector<std::pair<position, position>> xs;
+  position y {};
+  auto reach = [&] (event1 const& e)
+  {
+    auto p = get_position (e);
+    if (!xs.empty() && p != y)
+    {
+      for (auto&& x : xs)
+        region.add_span (x.first, x.second);
+      region.close_band (y, p);
+    }
+    y = p;
+    return std::make_pair (detail::rget_x1 (e.interval.rectangle), detail::rget_x2 (e.interval.rectangle));
+  };
+
+  algorithm::scan_events (counting_active_set<event1>{}, events
+                          , [&] (auto&&, event1 const& e)
+                            {
+                              auto x = reach (e);
+                              xs.insert (std::upper_bound (xs.begin(), xs.end(), x), x);
+                            }
+                          , [&] (auto&&, event1 const& e)
+                            {
+                              auto x = reach (e);
+                              xs.erase (std::lower_bound (xs.begin(), xs.end(), x));
+                            });
+  return region;
+}
+
+} }
+
+#endif
@@ -0,0 +1,595 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_BTREE_MULTISET_HPP
+#define ALGORITHM_BTREE_MULTISET_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <cassert>
+
+namespace exp { namespace algorithm {
+
+// Ordered multiset stored in a B+tree whose leaves hold many values
+// contiguously and are linked in order, so iterating it walks arrays
+// instead of chasing one heap node per value. It can replace
+// std::multiset<event> as the event set of a sweep.
+//
+// Iterator stability: insert never moves values ordered before the
+// inserted one, so a sweep can keep iterating while it inserts events
+// ahead of its cursor. Values after the inserted one in the same leaf
+// may move. erase invalidates iterators to the erased value and to the
+// values after it in the same leaf. Leaves emptied by erase are kept
+// until clear, the tree is never rebalanced.
+//
+// T must be default constructible and copy assignable.
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>
+          , std::size_t NodeBytes = 512>
+class btree_multiset
+{
+public:
+  typedef T key_type;
+  typedef T value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+  typedef Allocator allocator_type;
+  typedef T const& reference;
+  typedef T const& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+private:
+  struct leaf_link
+  {
+    leaf_link* prev;
+    leaf_link* next;
+    size_type count;
+  };
+
+public:
+  static constexpr size_type leaf_capacity
+    = (NodeBytes - sizeof (leaf_link)) / sizeof (T) < 4 ? 4 : (NodeBytes - sizeof (leaf_link)) / sizeof (T);
+  static constexpr size_type inner_capacity
+    = NodeBytes / (sizeof (T) + sizeof (void*)) < 4 ? 4 : NodeBytes / (sizeof (T) + sizeof (void*));
+
+private:
+  struct leaf : leaf_link
+  {
+    std::array<T, leaf_capacity> values;
+  };
+
+  struct inner
+  {
+    size_type count; // number of keys, children has one more
+    std::array<void*, inner_capacity + 1> children;
+    // every value in children[i] is not greater than keys[i] and every
+    // value in children[i + 1] is not less than it
+    std::array<T, inner_capacity> keys;
+  };
+
+  typedef typename std::allocator_traits<Allocator>::template rebind_alloc<leaf> leaf_allocator;
+  typedef typename std::allocator_traits<Allocator>::template rebind_alloc<inner> inner_allocator;
+
+public:
+  class const_iterator
+  {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef T const& reference;
+    typedef T const* pointer;
+    typedef std::ptrdiff_t difference_type;
+
+    const_iterator () = default;
+
+    reference operator*() const { return static_cast<leaf const*>(node)->values[index]; }
+    pointer operator->() const { return &**this; }
+
+    const_iterator& operator++()
+    {
+      ++index;
+      skip_forward ();
+      return *this;
+    }
+    const_iterator operator++(int)
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    const_iterator& operator--()
+    {
+      while (index == 0)
+      {
+        node = node->prev;
+        index = node->count;
+      }
+      --index;
+      return *this;
+    }
+    const_iterator operator--(int)
+    {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    bool operator==(const_iterator const& other) const { return node == other.node && index == other.index; }
+    bool operator!=(const_iterator const& other) const { return !(*this == other); }
+
+  private:
+    friend class btree_multiset;
+    const_iterator (leaf_link const* node, size_type index)
+      : node (node), index (index)
+    {
+      skip_forward ();
+    }
+
+    // the end of a leaf is the begin of the next non empty one, the
+    // header is the only link without a next and ends every walk
+    void skip_forward ()
+    {
+      while (index == node->count && node->next != nullptr)
+      {
+        node = node->next;
+        index = 0;
+      }
+    }
+
+    leaf_link const* node = nullptr;
+    size_type index = 0;
+  };
+  typedef const_iterator iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef const_reverse_iterator reverse_iterator;
+
+  btree_multiset ()
+    : btree_multiset (Compare(), Allocator()) {}
+  explicit btree_multiset (Compare const& compare, Allocator const& allocator = Allocator())
+    : compare (compare), leaves (allocator), inners (allocator)
+  {
+    reset ();
+  }
+  explicit btree_multiset (Allocator const& allocator)
+    : btree_multiset (Compare(), allocator) {}
+  template <typename InputIterator>
+  btree_multiset (InputIterator first, InputIterator last, Compare const& compare = Compare()
+                  , Allocator const& allocator = Allocator())
+    : btree_multiset (compare, allocator)
+  {
+    insert (first, last);
+  }
+  btree_multiset (btree_multiset const& other)
+    : btree_multiset (other.compare
+                      , std::allocator_traits<leaf_allocator>::select_on_container_copy_construction (other.leaves))
+  {
+    assign_sorted (other.begin(), other.end());
+  }
+  btree_multiset (btree_multiset&& other)
+    : compare (other.compare), leaves (other.leaves), inners (other.inners)
+  {
+    reset ();
+    swap_contents (other);
+  }
+  btree_multiset& operator=(btree_multiset const& other)
+  {
+    if (this != &other)
+      assign_sorted (other.begin(), other.end());
+    return *this;
+  }
+  btree_multiset& operator=(btree_multiset&& other)
+  {
+    if (this != &other)
+    {
+      clear ();
+      if (leaves == other.leaves)
+        swap_contents (other);
+      else
+        assign_sorted (other.begin(), other.end());
+    }
+    return *this;
+  }
+  ~btree_multiset ()
+  {
+    destroy (root, height);
+  }
+
+  const_iterator begin () const { return {first_leaf, 0}; }
+  const_iterator end () const { return {&header, 0}; }
+  const_iterator cbegin () const { return begin(); }
+  const_iterator cend () const { return end(); }
+  const_reverse_iterator rbegin () const { return const_reverse_iterator (end()); }
+  const_reverse_iterator rend () const { return const_reverse_iterator (begin()); }
+
+  size_type size () const { return values; }
+  bool empty () const { return values == 0; }
+  key_compare key_comp () const { return compare; }
+  value_compare value_comp () const { return compare; }
+  allocator_type get_allocator () const { return allocator_type (leaves); }
+
+  // Inserts after the values equivalent to v, like std::multiset
+  iterator insert (T const& v)
+  {
+    std::array<std::pair<inner*, size_type>, max_height> path;
+    size_type depth = 0;
+    void* node = root;
+    for (size_type level = height; level != 0; --level)
+    {
+      auto i = static_cast<inner*>(node);
+      auto child = static_cast<size_type>
+        (std::upper_bound (i->keys.begin(), i->keys.begin() + i->count, v, compare) - i->keys.begin());
+      path[depth++] = {i, child};
+      node = i->children[child];
+    }
+
+    auto l = static_cast<leaf*>(node);
+    auto p = static_cast<size_type>
+      (std::upper_bound (l->values.begin(), l->values.begin() + l->count, v, compare) - l->values.begin());
+    ++values;
+    if (l->count != leaf_capacity)
+    {
+      std::move_backward (l->values.begin() + p, l->values.begin() + l->count, l->values.begin() + l->count + 1);
+      l->values[p] = v;
+      ++l->count;
+      return {l, p};
+    }
+
+    // Full leaf, split it at the insertion point so nothing before v
+    // moves. v stays in l unless it goes at the very end.
+    leaf* right = new_leaf ();
+    right->prev = l;
+    right->next = l->next;
+    l->next->prev = right;
+    l->next = right;
+    iterator result;
+    if (p == l->count)
+    {
+      right->values[0] = v;
+      right->count = 1;
+      result = {right, 0};
+    }
+    else
+    {
+      std::move (l->values.begin() + p, l->values.begin() + l->count, right->values.begin());
+      right->count = l->count - p;
+      l->values[p] = v;
+      l->count = p + 1;
+      result = {l, p};
+    }
+    insert_child (path, depth, right->values[0], right);
+    return result;
+  }
+
+  // With end() as hint and v not less than the last value, v is
+  // appended to the last leaf without descending the tree unless the
+  // leaf is full. Other hints are ignored.
+  iterator insert (const_iterator hint, T const& v)
+  {
+    auto last = static_cast<leaf*>(header.prev);
+    if (hint == end() && last->count != 0 && last->count != leaf_capacity
+        && !compare (v, last->values[last->count - 1]))
+    {
+      last->values[last->count] = v;
+      ++values;
+      return {last, last->count++};
+    }
+    return insert (v);
+  }
+
+  template <typename InputIterator>
+  void insert (InputIterator first, InputIterator last)
+  {
+    for (; first != last; ++first)
+      insert (*first);
+  }
+
+  // Replaces the contents with [first, last), which must already be
+  // sorted. Leaves are filled completely and inner nodes are built
+  // over them, so this is linear and allocates only full nodes.
+  template <typename ForwardIterator>
+  void assign_sorted (ForwardIterator first, ForwardIterator last)
+  {
+    assert (std::is_sorted (first, last, compare));
+    clear ();
+    if (first == last)
+      return;
+
+    // the empty leaf from clear is the first one
+    std::size_t leaves = 1;
+    leaf* l = first_leaf;
+    while (true)
+    {
+      while (first != last && l->count != leaf_capacity)
+      {
+        l->values[l->count++] = *first;
+        ++first;
+        ++values;
+      }
+      if (first == last)
+        break;
+      leaf* next = new_leaf ();
+      next->prev = l;
+      next->next = &header;
+      l->next = next;
+      header.prev = next;
+      l = next;
+      ++leaves;
+    }
+
+    std::size_t reach = 1;
+    while (reach < leaves)
+    {
+      reach *= inner_capacity + 1;
+      ++height;
+    }
+    l = first_leaf;
+    root = build_sorted (l, height, leaves);
+  }
+
+  iterator erase (const_iterator position)
+  {
+    assert (position != end());
+    auto l = static_cast<leaf*>(const_cast<leaf_link*>(position.node));
+    std::move (l->values.begin() + position.index + 1, l->values.begin() + l->count
+               , l->values.begin() + position.index);
+    --l->count;
+    --values;
+    return {l, position.index};
+  }
+
+  size_type erase (T const& v)
+  {
+    size_type erased = 0;
+    for (auto it = lower_bound (v); it != end() && !compare (v, *it); it = lower_bound (v))
+    {
+      erase (it);
+      ++erased;
+    }
+    return erased;
+  }
+
+  const_iterator lower_bound (T const& v) const
+  {
+    void const* node = root;
+    for (size_type level = height; level != 0; --level)
+    {
+      auto i = static_cast<inner const*>(node);
+      node = i->children[std::lower_bound (i->keys.begin(), i->keys.begin() + i->count, v, compare) - i->keys.begin()];
+    }
+    auto l = static_cast<leaf const*>(node);
+    return {l, static_cast<size_type>(std::lower_bound (l->values.begin(), l->values.begin() + l->count, v, compare)
+                                      - l->values.begin())};
+  }
+
+  const_iterator upper_bound (T const& v) const
+  {
+    void const* node = root;
+    for (size_type level = height; level != 0; --level)
+    {
+      auto i = static_cast<inner const*>(node);
+      node = i->children[std::upper_bound (i->keys.begin(), i->keys.begin() + i->count, v, compare) - i->keys.begin()];
+    }
+    auto l = static_cast<leaf const*>(node);
+    return {l, static_cast<size_type>(std::upper_bound (l->values.begin(), l->values.begin() + l->count, v, compare)
+                                      - l->values.begin())};
+  }
+
+  std::pair<const_iterator, const_iterator> equal_range (T const& v) const
+  {
+    return {lower_bound (v), upper_bound (v)};
+  }
+
+  const_iterator find (T const& v) const
+  {
+    auto it = lower_bound (v);
+    return it != end() && !compare (v, *it) ? it : end();
+  }
+
+  size_type count (T const& v) const
+  {
+    auto range = equal_range (v);
+    return static_cast<size_type>(std::distance (range.first, range.second));
+  }
+
+  void clear ()
+  {
+    destroy (root, height);
+    reset ();
+  }
+
+  void swap (btree_multiset& other)
+  {
+    using std::swap;
+    swap (compare, other.compare);
+    swap (leaves, other.leaves);
+    swap (inners, other.inners);
+    swap_contents (other);
+  }
+
+  // bytes allocated for nodes, to compare with other containers
+  size_type memory_usage () const
+  {
+    return leaf_count * sizeof (leaf) + inner_count * sizeof (inner);
+  }
+
+private:
+  static constexpr size_type max_height = 32;
+
+  leaf* new_leaf ()
+  {
+    leaf* l = std::allocator_traits<leaf_allocator>::allocate (leaves, 1);
+    ::new (static_cast<void*>(l)) leaf ();
+    l->count = 0;
+    ++leaf_count;
+    return l;
+  }
+
+  inner* new_inner ()
+  {
+    inner* i = std::allocator_traits<inner_allocator>::allocate (inners, 1);
+    ::new (static_cast<void*>(i)) inner ();
+    i->count = 0;
+    ++inner_count;
+    return i;
+  }
+
+  // The subtree of the given height over the next leaves from l on, as
+  // full as they allow, walking the leaf links so the inner nodes of a
+  // bulk load need no other memory. Advances l and decrements leaves.
+  void* build_sorted (leaf*& l, size_type level, std::size_t& leaves)
+  {
+    if (level == 0)
+    {
+      leaf* built = l;
+      if (--leaves != 0)
+        l = static_cast<leaf*>(l->next);
+      return built;
+    }
+    inner* i = new_inner ();
+    size_type children = 0;
+    while (children != inner_capacity + 1 && leaves != 0)
+    {
+      T const& key = l->values[0];
+      if (children != 0)
+        i->keys[children - 1] = key;
+      i->children[children++] = build_sorted (l, level - 1, leaves);
+    }
+    i->count = children - 1;
+    return i;
+  }
+
+  // Adds child right after path[depth - 1], splitting inner nodes up
+  // to the root when they are full. key is the first value of child.
+  template <typename Path>
+  void insert_child (Path& path, size_type depth, T key, void* child)
+  {
+    while (depth != 0)
+    {
+      --depth;
+      inner* i = path[depth].first;
+      size_type c = path[depth].second;
+      if (i->count != inner_capacity)
+      {
+        std::move_backward (i->keys.begin() + c, i->keys.begin() + i->count, i->keys.begin() + i->count + 1);
+        std::move_backward (i->children.begin() + c + 1, i->children.begin() + i->count + 1
+                            , i->children.begin() + i->count + 2);
+        i->keys[c] = key;
+        i->children[c + 1] = child;
+        ++i->count;
+        return;
+      }
+
+      // full inner node, split it in the middle and push the middle key up
+      std::array<T, inner_capacity + 1> keys;
+      std::array<void*, inner_capacity + 2> children;
+      std::move (i->keys.begin(), i->keys.begin() + c, keys.begin());
+      keys[c] = key;
+      std::move (i->keys.begin() + c, i->keys.begin() + i->count, keys.begin() + c + 1);
+      std::copy (i->children.begin(), i->children.begin() + c + 1, children.begin());
+      children[c + 1] = child;
+      std::copy (i->children.begin() + c + 1, i->children.begin() + i->count + 1, children.begin() + c + 2);
+
+      size_type const middle = (inner_capacity + 1) / 2;
+      inner* right = new_inner ();
+      std::move (keys.begin(), keys.begin() + middle, i->keys.begin());
+      std::copy (children.begin(), children.begin() + middle + 1, i->children.begin());
+      i->count = middle;
+      std::move (keys.begin() + middle + 1, keys.end(), right->keys.begin());
+      std::copy (children.begin() + middle + 1, children.end(), right->children.begin());
+      right->count = inner_capacity - middle;
+      key = keys[middle];
+      child = right;
+    }
+
+    // the root was split
+    inner* new_root = new_inner ();
+    new_root->count = 1;
+    new_root->keys[0] = key;
+    new_root->children[0] = root;
+    new_root->children[1] = child;
+    root = new_root;
+    ++height;
+    assert (height < max_height);
+  }
+
+  void destroy (void* node, size_type level)
+  {
+    if (level == 0)
+    {
+      auto l = static_cast<leaf*>(node);
+      l->~leaf ();
+      std::allocator_traits<leaf_allocator>::deallocate (leaves, l, 1);
+      --leaf_count;
+    }
+    else
+    {
+      auto i = static_cast<inner*>(node);
+      for (size_type c = 0; c != i->count + 1; ++c)
+        destroy (i->children[c], level - 1);
+      i->~inner ();
+      std::allocator_traits<inner_allocator>::deallocate (inners, i, 1);
+      --inner_count;
+    }
+  }
+
+  // an empty tree is one empty leaf linked to the header
+  void reset ()
+  {
+    leaf* l = new_leaf ();
+    l->prev = nullptr;
+    l->next = &header;
+    header.prev = l;
+    header.next = nullptr;
+    header.count = 0;
+    first_leaf = l;
+    root = l;
+    height = 0;
+    values = 0;
+  }
+
+  void swap_contents (btree_multiset& other)
+  {
+    using std::swap;
+    swap (root, other.root);
+    swap (first_leaf, other.first_leaf);
+    swap (height, other.height);
+    swap (values, other.values);
+    swap (leaf_count, other.leaf_count);
+    swap (inner_count, other.inner_count);
+    swap (header.prev, other.header.prev);
+    header.prev->next = &header;
+    other.header.prev->next = &other.header;
+  }
+
+  Compare compare;
+  leaf_allocator leaves;
+  inner_allocator inners;
+  leaf_link header;
+  leaf* first_leaf = nullptr;
+  void* root = nullptr;
+  size_type height = 0;
+  size_type values = 0;
+  size_type leaf_count = 0;
+  size_type inner_count = 0;
+};
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void swap (btree_multiset<T, Compare, Allocator, NodeBytes>& l, btree_multiset<T, Compare, Allocator, NodeBytes>& r)
+{
+  l.swap (r);
+}
+
+} }
+
+#endif
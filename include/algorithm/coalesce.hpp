@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_COALESCE_HPP
+#define ALGORITHM_COALESCE_HPP
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/split_rectangles.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace exp { namespace algorithm {
+
+namespace detail {
+
+// A rectangle as {across1, across2, along1, along2}: the interval it
+// must share with another one and the interval where they must touch
+template <typename Position>
+using coalesce_key = std::array<Position, 4>;
+
+// One sweep along a dimension: sorts the keys, so runs with the same
+// across interval are sorted by where they begin, and merges the ones
+// that touch. Returns true if anything was merged.
+template <typename Position>
+bool coalesce_pass (std::vector<coalesce_key<Position>>& keys)
+{
+  std::sort (keys.begin(), keys.end());
+  std::size_t out = 0;
+  for (std::size_t i = 0; i != keys.size(); ++i)
+  {
+    if (out != 0 && keys[out - 1][0] == keys[i][0] && keys[out - 1][1] == keys[i][1]
+        && keys[out - 1][3] == keys[i][2])
+      keys[out - 1][3] = keys[i][3];
+    else
+      keys[out++] = keys[i];
+  }
+  bool merged = out != keys.size();
+  keys.resize (out);
+  return merged;
+}
+
+// swaps the across and along intervals of every key
+template <typename Position>
+void transpose (std::vector<coalesce_key<Position>>& keys)
+{
+  for (auto&& k : keys)
+    k = {k[2], k[3], k[0], k[1]};
+}
+
+}
+
+// Merges disjoint rectangles that share their x interval and touch
+// vertically, or share their y interval and touch horizontally, into
+// one. Meant for the output of rectangle_partition, which leaves such
+// runs where the split cases cut a rectangle that a later one does not
+// need cut. Each pass is a sort and a linear merge along one
+// dimension, O(n log n), and passes alternate between dimensions. A
+// merge along one dimension can make two rectangles mergeable along
+// the other, so reaching a set where nothing can be merged may take up
+// to n + 1 passes. Coalescing stops there or after max_passes passes,
+// whichever comes first, so it is O(max_passes n log n) and the result
+// is best-effort: it may still hold mergeable pairs when the limit is
+// reached. Passing rects.size() + 1 always merges everything.
+template <typename Container>
+Container coalesce_rectangles (Container rects, std::size_t max_passes = 8)
+{
+  typedef typename Container::value_type rectangle;
+  typedef typename detail::rectangle_position<rectangle>::type position;
+  std::vector<detail::coalesce_key<position>> keys;
+  keys.reserve (rects.size());
+  for (auto&& r : rects)
+    keys.push_back ({detail::rget_x1 (r), detail::rget_x2 (r), detail::rget_y1 (r), detail::rget_y2 (r)});
+
+  // a pass leaves nothing to merge along its own dimension, the first
+  // one goes along y
+  bool along_y = true;
+  if (max_passes != 0)
+    detail::coalesce_pass (keys);
+  for (std::size_t pass = 1; pass < max_passes; ++pass)
+  {
+    detail::transpose (keys);
+    along_y = !along_y;
+    if (!detail::coalesce_pass (keys))
+      break;
+  }
+
+  rects.clear();
+  for (auto&& k : keys)
+    detail::insert_rectangle (rects, along_y ? rectangle {{k[0], k[1]}, {k[2], k[3]}}
+                                             : rectangle {{k[2], k[3]}, {k[0], k[1]}});
+  return rects;
+}
+
+// rectangle_partition followed by coalesce_rectangles
+template <typename Container, typename Trace = null_trace>
+Container coalesced_rectangle_partition (Container rects, Trace&& trace = Trace{})
+{
+  return algorithm::coalesce_rectangles
+    (algorithm::rectangle_partition (std::move (rects), std::forward<Trace> (trace)));
+}
+
+} }
+
+#endif
@@ -0,0 +1,146 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_COORDINATE_COMPRESSION_HPP
+#define ALGORITHM_COORDINATE_COMPRESSION_HPP
+
+#include <algorithm/rectangle.hpp>
+#include <algorithm/split_rectangles.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <cassert>
+
+namespace exp { namespace algorithm {
+
+// Maps every distinct coordinate of a set to its rank, 0 to size() - 1,
+// in coordinate order, and ranks back to coordinates. Stages after it
+// can index arrays, Fenwick trees or bitsets by rank even when the
+// coordinates are sparse or 64 bit.
+template <typename Position>
+class coordinate_compression
+{
+public:
+  typedef Position position_type;
+  typedef std::uint32_t rank_type;
+
+  coordinate_compression () = default;
+  template <typename InputIterator>
+  coordinate_compression (InputIterator first, InputIterator last)
+    : coordinates (first, last)
+  {
+    std::sort (coordinates.begin(), coordinates.end());
+    coordinates.erase (std::unique (coordinates.begin(), coordinates.end()), coordinates.end());
+    assert (coordinates.size() <= std::numeric_limits<rank_type>::max());
+  }
+
+  std::size_t size () const { return coordinates.size(); }
+  bool empty () const { return coordinates.empty(); }
+
+  // p must be one of the compressed coordinates
+  rank_type rank (Position const& p) const
+  {
+    auto it = std::lower_bound (coordinates.begin(), coordinates.end(), p);
+    assert (it != coordinates.end() && *it == p);
+    return static_cast<rank_type>(it - coordinates.begin());
+  }
+
+  bool contains (Position const& p) const
+  {
+    return std::binary_search (coordinates.begin(), coordinates.end(), p);
+  }
+
+  Position const& position (rank_type r) const { return coordinates[r]; }
+  Position const& operator[](rank_type r) const { return coordinates[r]; }
+
+  // every coordinate, sorted, indexed by rank
+  std::vector<Position> const& positions () const { return coordinates; }
+
+private:
+  std::vector<Position> coordinates;
+};
+
+// Rectangles with both dimensions replaced by ranks, plus the
+// compressions to map them back. rects[i] is input rectangle i, empty
+// rectangles included, so callers can keep using input indices.
+template <typename Position>
+struct compressed_rectangles
+{
+  typedef typename coordinate_compression<Position>::rank_type rank_type;
+  typedef std::pair<rank_type, rank_type> interval;
+  typedef algorithm::rectangle<interval, interval> rectangle;
+
+  coordinate_compression<Position> x, y;
+  std::vector<rectangle> rects;
+
+  // the coordinates of a rectangle of ranks
+  template <typename Rectangle>
+  Rectangle decompress (rectangle const& r) const
+  {
+    return Rectangle {{x[r.i0.first], x[r.i0.second]}, {y[r.i1.first], y[r.i1.second]}};
+  }
+};
+
+namespace detail {
+
+// ranks of values[i] for every i, by sorting indices once instead of
+// a binary search per value
+template <typename Position>
+std::vector<std::uint32_t> rank_values (std::vector<Position> const& values, coordinate_compression<Position>& compression)
+{
+  std::vector<std::pair<Position, std::uint32_t>> order (values.size());
+  std::vector<std::uint32_t> ranks (values.size());
+  for (std::size_t i = 0; i != order.size(); ++i)
+    order[i] = {values[i], static_cast<std::uint32_t>(i)};
+  std::sort (order.begin(), order.end());
+  std::vector<Position> distinct;
+  for (auto&& v : order)
+  {
+    if (distinct.empty() || distinct.back() < v.first)
+      distinct.push_back (v.first);
+    ranks[v.second] = static_cast<std::uint32_t>(distinct.size() - 1);
+  }
+  compression = coordinate_compression<Position> (distinct.begin(), distinct.end());
+  return ranks;
+}
+
+}
+
+// Compresses the x and the y coordinates of rects separately
+template <typename Container>
+compressed_rectangles<typename detail::rectangle_position<typename Container::value_type>::type>
+  compress_rectangles (Container const& rects)
+{
+  typedef typename detail::rectangle_position<typename Container::value_type>::type position;
+  std::vector<position> xs, ys;
+  xs.reserve (2 * rects.size());
+  ys.reserve (2 * rects.size());
+  for (auto&& r : rects)
+  {
+    xs.push_back (detail::rget_x1 (r));
+    xs.push_back (detail::rget_x2 (r));
+    ys.push_back (detail::rget_y1 (r));
+    ys.push_back (detail::rget_y2 (r));
+  }
+
+  compressed_rectangles<position> result;
+  auto x_ranks = detail::rank_values (xs, result.x);
+  auto y_ranks = detail::rank_values (ys, result.y);
+  result.rects.reserve (rects.size());
+  for (std::size_t i = 0; i != rects.size(); ++i)
+    result.rects.push_back ({{x_ranks[2 * i], x_ranks[2 * i + 1]}, {y_ranks[2 * i], y_ranks[2 * i + 1]}});
+  return result;
+}
+
+} }
+
+#endif
@@ -0,0 +1,213 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_DYNAMIC_PARTITION_HPP
+#define ALGORITHM_DYNAMIC_PARTITION_HPP
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/split_rectangles.hpp>
+#include <algorithm/interval_index.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace exp { namespace algorithm {
+
+// A partition of the area covered by a set of rectangles that is kept
+// up to date as rectangles are inserted and erased, for sets that
+// change a little at a time.
+//
+// Every fragment is owned by one input rectangle and lies inside it.
+// Inserting a rectangle adds the parts of it that no other input
+// covers, owned by it. Erasing one removes the fragments it owns and
+// covers their area again with the other inputs that overlap it. Only
+// the inputs that overlap the changed rectangle are visited, found by
+// their interval in dim-0 in an interval_index, so an update costs
+// about the number of inputs and fragments around it however wide the
+// other inputs are.
+// The fragments are disjoint but not the ones rectangle_partition
+// would return for the same inputs, since they depend on the order of
+// the updates.
+template <typename Rectangle>
+class dynamic_rectangle_partition
+{
+public:
+  typedef Rectangle value_type;
+  typedef typename detail::rectangle_position<Rectangle>::type position_type;
+
+  dynamic_rectangle_partition () = default;
+  template <typename Container>
+  explicit dynamic_rectangle_partition (Container const& rects)
+  {
+    for (auto&& r : rects)
+      insert (r);
+  }
+
+  // the current fragments, in no particular order
+  std::vector<Rectangle> const& fragments () const { return fragments_; }
+
+  // number of input rectangles
+  std::size_t size () const { return index.size(); }
+  bool empty () const { return index.empty(); }
+
+  void insert (Rectangle const& r)
+  {
+    auto id = new_input (r);
+    if (!is_empty (r))
+    {
+      pieces.clear();
+      pieces.push_back (r);
+      for_each_input (r, [&] (std::size_t other)
+                      {
+                        return !detail::split_pieces (inputs[other].rectangle, pieces, scratch, null_trace{});
+                      });
+      for (auto&& piece : pieces)
+        add_fragment (piece, id);
+    }
+    index.insert (detail::rget_x1 (r), detail::rget_x2 (r), id);
+  }
+
+  // Erases one input equal to r, returns false if there is none
+  bool erase (Rectangle const& r)
+  {
+    std::size_t id = inputs.size();
+    index.for_each_at (detail::rget_x1 (r), [&] (std::size_t other)
+                       {
+                         if (!(inputs[other].rectangle == r))
+                           return true;
+                         id = other;
+                         return false;
+                       });
+    if (id == inputs.size())
+      return false;
+    index.erase (detail::rget_x1 (r), id);
+
+    // the area only r covered is freed, the other inputs over it take it
+    freed.clear();
+    while (!inputs[id].fragments.empty())
+    {
+      freed.push_back (fragments_[inputs[id].fragments.back()]);
+      remove_fragment (inputs[id].fragments.back());
+    }
+    for (auto&& f : freed)
+    {
+      pieces.clear();
+      pieces.push_back (f);
+      for_each_input (f, [&] (std::size_t other)
+                      {
+                        auto const& s = inputs[other].rectangle;
+                        for (auto&& piece : pieces)
+                          if (detail::rectangles_overlap (piece, s))
+                            add_fragment (intersection (piece, s), other);
+                        return !detail::split_pieces (s, pieces, scratch, null_trace{});
+                      });
+    }
+    free_inputs.push_back (id);
+    return true;
+  }
+
+  void clear ()
+  {
+    fragments_.clear();
+    owners.clear();
+    owned_at.clear();
+    inputs.clear();
+    free_inputs.clear();
+    index.clear();
+  }
+
+private:
+  struct input
+  {
+    Rectangle rectangle;
+    // indices in fragments_ of the fragments it owns
+    std::vector<std::size_t> fragments;
+  };
+
+  static bool is_empty (Rectangle const& r)
+  {
+    return !(detail::rget_x1 (r) < detail::rget_x2 (r) && detail::rget_y1 (r) < detail::rget_y2 (r));
+  }
+
+  static Rectangle intersection (Rectangle const& l, Rectangle const& r)
+  {
+    return Rectangle {{std::max (detail::rget_x1 (l), detail::rget_x1 (r)), std::min (detail::rget_x2 (l), detail::rget_x2 (r))}
+                      , {std::max (detail::rget_y1 (l), detail::rget_y1 (r)), std::min (detail::rget_y2 (l), detail::rget_y2 (r))}};
+  }
+
+  std::size_t new_input (Rectangle const& r)
+  {
+    if (free_inputs.empty())
+    {
+      inputs.push_back ({r, {}});
+      return inputs.size() - 1;
+    }
+    auto id = free_inputs.back();
+    free_inputs.pop_back();
+    inputs[id].rectangle = r;
+    return id;
+  }
+
+  // Calls f (id) for every indexed input that overlaps r, in order of
+  // x1, until f returns false. Empty inputs cover nothing and are
+  // skipped.
+  template <typename F>
+  void for_each_input (Rectangle const& r, F&& f) const
+  {
+    index.for_each_overlap (detail::rget_x1 (r), detail::rget_x2 (r), [&] (std::size_t other)
+                            {
+                              auto const& s = inputs[other].rectangle;
+                              return is_empty (s) || !detail::rectangles_overlap (s, r) || f (other);
+                            });
+  }
+
+  void add_fragment (Rectangle const& r, std::size_t owner)
+  {
+    owned_at.push_back (inputs[owner].fragments.size());
+    inputs[owner].fragments.push_back (fragments_.size());
+    fragments_.push_back (r);
+    owners.push_back (owner);
+  }
+
+  // moves the last fragment into i, and the last fragment of its owner
+  // into its place in the owner, both through the back-links
+  void remove_fragment (std::size_t i)
+  {
+    auto& owned = inputs[owners[i]].fragments;
+    owned[owned_at[i]] = owned.back();
+    owned_at[owned.back()] = owned_at[i];
+    owned.pop_back();
+    std::size_t last = fragments_.size() - 1;
+    if (i != last)
+    {
+      fragments_[i] = fragments_[last];
+      owners[i] = owners[last];
+      owned_at[i] = owned_at[last];
+      inputs[owners[i]].fragments[owned_at[i]] = i;
+    }
+    fragments_.pop_back();
+    owners.pop_back();
+    owned_at.pop_back();
+  }
+
+  std::vector<Rectangle> fragments_;
+  // owners[i] is the input that owns fragments_[i], and owned_at[i]
+  // where it is in the fragments of that input
+  std::vector<std::size_t> owners, owned_at;
+  std::vector<input> inputs;
+  std::vector<std::size_t> free_inputs;
+  // the dim-0 interval of every input
+  interval_index<position_type> index;
+  std::vector<Rectangle> pieces, scratch, freed;
+};
+
+} }
+
+#endif
@@ -171,6 +171,8 @@ struct associative_interval_insert_iterator : interval_insert_iterator_base<Cont
   }
 };
 
+// Each interval costs two binary searches and two vector inserts, see
+// insert_intervals in event_builder.hpp to add many at once.
 template <typename Event, typename Container>
 struct sequence_interval_insert_iterator : interval_insert_iterator_base<Container, sequence_interval_insert_iterator<Event, Container>>
 {
@@ -0,0 +1,259 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_EVENT_BUILDER_HPP
+#define ALGORITHM_EVENT_BUILDER_HPP
+
+#include <algorithm/event.hpp>
+#include <algorithm/btree_multiset.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace exp { namespace algorithm {
+
+// Builds whole event sets at once instead of one interval at a time
+// through interval_inserter. Events are sorted in the order of
+// operator<, which is the same as sorting on the key
+//
+//   (position, type, end position for begin events)
+//
+// with begin before end. Integral positions are sorted with a stable
+// LSD radix sort on that key, in linear time and with a single scratch
+// buffer. Other positions use std::stable_sort. Both keep equivalent
+// events in the order they were emitted, like inserting them one by
+// one into a std::multiset does.
+
+namespace detail {
+
+// maps positions to unsigned values with the same order
+template <typename P>
+typename std::make_unsigned<P>::type radix_key (P p)
+{
+  typedef typename std::make_unsigned<P>::type key;
+  key k = static_cast<key>(p);
+  if (std::is_signed<P>::value)
+    k ^= key (1) << (std::numeric_limits<key>::digits - 1);
+  return k;
+}
+
+// The sort key of an event split in the parts that are radix sorted.
+// End events use their own position as the last part, which does not
+// change their order. Keys are taken relative to the smallest one so
+// the high digits are usually the same for all events and skipped.
+template <typename Event>
+struct event_sort_key
+{
+  typedef typename algorithm::interval_api::interval_position_type<typename Event::interval_type>::type position;
+  typedef typename std::make_unsigned<position>::type key;
+  static constexpr std::size_t bytes = sizeof (position);
+  static constexpr std::size_t digits = 2 * bytes + 1;
+
+  event_sort_key (Event const& e, key min)
+  {
+    using algorithm::event_api::get_position;
+    using algorithm::event_api::is_begin_event;
+    using algorithm::interval_api::get_interval_end;
+    begin = is_begin_event (e);
+    position_key = radix_key (get_position (e)) - min;
+    end_key = radix_key (get_interval_end (e.interval)) - min;
+  }
+
+  // least significant digit first
+  unsigned digit (std::size_t d) const
+  {
+    if (d < bytes)
+      return (end_key >> (8 * d)) & 0xff;
+    else if (d == bytes)
+      return begin ? 0 : 1;
+    else
+      return (position_key >> (8 * (d - bytes - 1))) & 0xff;
+  }
+
+  key position_key;
+  key end_key;
+  bool begin;
+};
+
+template <typename Event, typename Allocator>
+void radix_sort_events (std::vector<Event, Allocator>& events, std::vector<Event, Allocator>& scratch)
+{
+  using algorithm::event_api::get_position;
+  typedef event_sort_key<Event> sort_key;
+  std::size_t const n = events.size();
+
+  // positions are the smallest keys, the end of an interval is never
+  // before its begin
+  auto min = radix_key (get_position (events[0]));
+  for (auto&& e : events)
+    min = std::min (min, radix_key (get_position (e)));
+
+  // every histogram in one pass, digits where all events agree are skipped
+  std::array<std::array<std::size_t, 256>, sort_key::digits> counts {};
+  for (auto&& e : events)
+  {
+    sort_key k (e, min);
+    for (std::size_t d = 0; d != sort_key::digits; ++d)
+      ++counts[d][k.digit (d)];
+  }
+
+  scratch.resize (n);
+  for (std::size_t d = 0; d != sort_key::digits; ++d)
+  {
+    auto& count = counts[d];
+    if (count[sort_key (events[0], min).digit (d)] == n)
+      continue;
+    std::size_t offset = 0;
+    for (auto& c : count)
+    {
+      auto size = c;
+      c = offset;
+      offset += size;
+    }
+    for (auto&& e : events)
+      scratch[count[sort_key (e, min).digit (d)]++] = e;
+    events.swap (scratch);
+  }
+}
+
+template <typename Event, typename Enable = void>
+struct has_integral_position : std::false_type {};
+
+template <typename Event>
+struct has_integral_position
+  <Event, typename std::enable_if
+   <std::is_integral<typename algorithm::interval_api::interval_position_type
+                     <typename Event::interval_type>::type>::value>::type>
+  : std::true_type {};
+
+template <typename Event, typename Allocator>
+void sort_events (std::vector<Event, Allocator>& events, std::vector<Event, Allocator>& scratch, std::true_type)
+{
+  if (events.size() > 1)
+    detail::radix_sort_events (events, scratch);
+}
+
+template <typename Event, typename Allocator>
+void sort_events (std::vector<Event, Allocator>& events, std::vector<Event, Allocator>&, std::false_type)
+{
+  std::stable_sort (events.begin(), events.end());
+}
+
+}
+
+// Sorts events in event order, keeping equivalent events in place.
+// scratch is the radix sort buffer for integral positions, kept by
+// callers that sort often so its capacity is reused.
+template <typename Event, typename Allocator>
+void sort_events (std::vector<Event, Allocator>& events, std::vector<Event, Allocator>& scratch)
+{
+  detail::sort_events (events, scratch, detail::has_integral_position<Event>{});
+}
+
+template <typename Event, typename Allocator>
+void sort_events (std::vector<Event, Allocator>& events)
+{
+  std::vector<Event, Allocator> scratch (events.get_allocator());
+  algorithm::sort_events (events, scratch);
+}
+
+// The begin and end events of every interval in [first, last), sorted.
+// The values in the range are converted to Event::interval_type, so a
+// range of rectangles builds events of detail::interval_n.
+template <typename Event, typename InputIterator>
+std::vector<Event> make_events (InputIterator first, InputIterator last)
+{
+  typedef typename Event::interval_type interval;
+  std::vector<Event> events;
+  if (std::is_base_of<std::forward_iterator_tag
+                      , typename std::iterator_traits<InputIterator>::iterator_category>::value)
+    events.reserve (2 * static_cast<std::size_t>(std::distance (first, last)));
+  for (; first != last; ++first)
+  {
+    interval i {*first};
+    events.push_back ({event_type::begin, i});
+    events.push_back ({event_type::end, i});
+  }
+  algorithm::sort_events (events);
+  return events;
+}
+
+// The begin events only, for sweeps that add end events as they go
+template <typename Event, typename InputIterator>
+std::vector<Event> make_begin_events (InputIterator first, InputIterator last)
+{
+  typedef typename Event::interval_type interval;
+  std::vector<Event> events;
+  if (std::is_base_of<std::forward_iterator_tag
+                      , typename std::iterator_traits<InputIterator>::iterator_category>::value)
+    events.reserve (static_cast<std::size_t>(std::distance (first, last)));
+  for (; first != last; ++first)
+    events.push_back ({event_type::begin, interval {*first}});
+  algorithm::sort_events (events);
+  return events;
+}
+
+namespace detail {
+
+// hinted at the end, a sorted input goes after what it inserted before
+// and after the equivalent events already in c, in amortized O(1)
+// when it goes after everything in c
+template <typename Container, typename ForwardIterator>
+void insert_sorted_events (Container& c, ForwardIterator first, ForwardIterator last, std::true_type)
+{
+  for (; first != last; ++first)
+    c.insert (c.end(), *first);
+}
+
+// appended and merged, equivalent events already in c stay first
+template <typename Container, typename ForwardIterator>
+void insert_sorted_events (Container& c, ForwardIterator first, ForwardIterator last, std::false_type)
+{
+  auto size = c.size();
+  c.insert (c.end(), first, last);
+  std::inplace_merge (c.begin(), std::next (c.begin(), size), c.end());
+}
+
+}
+
+// Inserts events from [first, last), sorted, into an event container
+// the way interval_inserter would, but in bulk.
+template <typename Container, typename ForwardIterator>
+void insert_sorted_events (Container& c, ForwardIterator first, ForwardIterator last)
+{
+  detail::insert_sorted_events (c, first, last, detail::has_key_compare<Container>{});
+}
+
+template <typename Event, typename Compare, typename Allocator, std::size_t NodeBytes, typename ForwardIterator>
+void insert_sorted_events (btree_multiset<Event, Compare, Allocator, NodeBytes>& c
+                           , ForwardIterator first, ForwardIterator last)
+{
+  if (c.empty())
+    c.assign_sorted (first, last);
+  else
+    detail::insert_sorted_events (c, first, last, std::true_type{});
+}
+
+// Adds the begin and end events of every interval in [first, last) to
+// c. Replaces copying through interval_inserter, which costs two
+// binary searches and two inserts per interval.
+template <typename Event, typename Container, typename InputIterator>
+void insert_intervals (Container& c, InputIterator first, InputIterator last)
+{
+  auto events = algorithm::make_events<Event> (first, last);
+  algorithm::insert_sorted_events (c, events.begin(), events.end());
+}
+
+} }
+
+#endif
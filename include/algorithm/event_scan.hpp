@@ -10,11 +10,16 @@
 #define ALGORITHM_EVENT_SCAN_HPP
 
 #include <algorithm/event.hpp>
+#include <algorithm/sweep_trace.hpp>
+#include <algorithm/active_set.hpp>
 
 #include <algorithm>
-#include <ostream>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <cassert>
-#include <iostream>
 
 namespace exp { namespace algorithm {
 
@@ -23,169 +28,157 @@ enum class sweep_interrupt
   continue_, break_
 };
 
-template <typename ActiveContainer, typename Container, typename Open, typename Close>
-void scan_events (ActiveContainer&& actives, Container const& c, Open&& open, Close&& close)
+// Sweeps the sorted events in c. Begin events are inserted in actives
+// and end events erase their begin event from it after close is
+// called. actives is any container supported by active_set_api, e.g.
+// std::vector, std::multiset or tombstone_active_set.
+template <typename ActiveContainer, typename Container, typename Open, typename Close, typename Trace = null_trace>
+void scan_events (ActiveContainer&& actives, Container const& c, Open&& open, Close&& close, Trace&& trace = Trace{})
 {
-  std::less<typename Container::value_type> compare;
   for (auto&& i : c)
   {
     using algorithm::event_api::is_begin_event;
     using algorithm::event_api::is_end_event;
     using algorithm::event_api::get_opposite_event;
+    using algorithm::active_set_api::insert_active;
+    using algorithm::active_set_api::erase_active;
+    trace (trace_point::event, i);
     if (is_begin_event(i))
     {
-      actives.push_back (i);
+      insert_active (actives, i);
       open (actives, i);
     }
     else if (is_end_event(i))
     {
       close (actives, i);
-      auto opposite = get_opposite_event(i);
-      auto it = std::lower_bound (actives.begin(), actives.end(), opposite, compare);
-      while (it != actives.end() && *it != opposite)
-        ++it;
-      assert (it != actives.end());
-      actives.erase (it);
+      bool erased = erase_active (actives, get_opposite_event(i));
+      assert (erased);
+      static_cast<void>(erased);
     }
   }
 }
 
-template <typename ActiveContainer, typename Container, typename Close>
+template <typename ActiveContainer, typename Container, typename Close, typename Trace = null_trace>
 std::enable_if<std::is_same<void, typename std::invoke_result<Close&&, ActiveContainer&&, typename Container::value_type&&>::type>::value>::type
-  scan_events (ActiveContainer&& actives, Container const& c, std::nullptr_t, Close&& close)
+  scan_events (ActiveContainer&& actives, Container const& c, std::nullptr_t, Close&& close, Trace&& trace = Trace{})
 {
-  std::less<typename Container::value_type> compare;
   for (auto&& i : c)
   {
     using algorithm::event_api::is_begin_event;
     using algorithm::event_api::is_end_event;
     using algorithm::event_api::get_opposite_event;
+    using algorithm::active_set_api::insert_active;
+    using algorithm::active_set_api::erase_active;
+    trace (trace_point::event, i);
     if (is_begin_event(i))
     {
-      actives.push_back (i);
+      insert_active (actives, i);
     }
     else if (is_end_event(i))
     {
       close (actives, i);
-      auto opposite = get_opposite_event(i);
-      auto it = std::lower_bound (actives.begin(), actives.end(), opposite, compare);
-      while (it != actives.end() && *it != opposite)
-        ++it;
-      assert (it != actives.end());
-      actives.erase (it);
+      bool erased = erase_active (actives, get_opposite_event(i));
+      assert (erased);
+      static_cast<void>(erased);
     }
   }
 }
 
-template <typename ActiveContainer, typename Container, typename Close>
+template <typename ActiveContainer, typename Container, typename Close, typename Trace = null_trace>
 std::enable_if<std::is_same<sweep_interrupt, typename std::invoke_result<Close&&, ActiveContainer&&, typename Container::value_type&&>::type>::value, sweep_interrupt>::type
-  scan_events (ActiveContainer&& actives, Container const& c, std::nullptr_t, Close&& close)
+  scan_events (ActiveContainer&& actives, Container const& c, std::nullptr_t, Close&& close, Trace&& trace = Trace{})
 {
-  typedef typename algorithm::interval_api::interval_position_type<typename Container::value_type::interval_type>::type position_type;
-  position_type position = std::numeric_limits<position_type>::min();
-  std::less<typename Container::value_type> const compare;
   auto it = c.begin(), last = c.end();
   while (it != last)
   {
     using algorithm::event_api::get_position;
-    // assert(std::is_sorted (actives.begin(), actives.end(), compare));
-    auto i = *it;
-    assert (it == last || get_position(i) <= get_position(*it) );
-    assert (position <= get_position(i));
-    position = get_position(i);
-    // assert(std::is_sorted (actives.begin(), actives.end(), compare));
-    // if (Container::value_type::interval_type::dim::value)
-    std::cout << Container::value_type::interval_type::dim::value
-              << " POSITION " << get_position(i) << " event to handle from set " << i << " (next is " << *it << ") C size: " << c.size()
-              << " before me: " << std::distance (c.begin(), it) << " after me: " << std::distance (it, last) << std::endl;
     using algorithm::event_api::is_begin_event;
     using algorithm::event_api::is_end_event;
     using algorithm::event_api::get_opposite_event;
+    using algorithm::active_set_api::insert_active;
+    using algorithm::active_set_api::erase_active;
+    // close may insert into c, but never behind the current event
+    auto i = *it;
+    assert (std::next (it) == last || get_position (i) <= get_position (*std::next (it)));
+    trace (trace_point::event, i);
     if (is_begin_event(i))
     {
-      // if (Container::value_type::interval_type::dim::value)
-      //std::cout << "pushing to actives container of dim(" << Container::value_type::interval_type::dim::value << ") is " << i << std::endl;
-      // assert(std::is_sorted (actives.begin(), actives.end(), compare));
-      actives.push_back (i);
-      // if(!std::is_sorted (actives.begin(), actives.end(), compare))
-      // {
-      //   std::cout << "dumping actives:" << std::endl;
-      //   for (auto&& a : actives)
-      //   {
-      //     std::cout << "    active: " << a << std::endl;
-      //   }
-      //   std::cout << "dumping current set:" << std::endl;
-      //   for (auto&& a : c)
-      //   {
-      //     if (i == a)
-      //       std::cout << "====>";
-      //     std::cout << "    active: " << a << std::endl;
-      //   }
-      //   std::cout << "trying to add " << i << " at end" << std::endl;
-      // }
-      // assert(std::is_sorted (actives.begin(), actives.end(), compare));
+      insert_active (actives, i);
     }
     else if (is_end_event(i))
     {
-      {
-        // assert(std::is_sorted (actives.begin(), actives.end(), compare));
-        auto opposite = get_opposite_event(i);
-        //std::cout << "event is " << i << " opposite is " << opposite << std::endl;
-        auto cop = std::find (actives.begin(), actives.end(), opposite);
-        if (cop != actives.end())
-        {
-          std::cout << "cop: " << *cop << std::endl;
-          assert (cop != actives.end());
-        }
-
-        // auto pair = std::equal_range (actives.begin(), actives.end(), opposite, compare);
-        // while (pair.first != pair.second && *pair.first != opposite)
-        // {
-        //   // std::cout << "searching " << opposite << " checking equal range for " << *pair.first << " but is false, trying next" << std::endl;
-        //   ++pair.first;
-        // }
-        // assert (pair.first == pair.second || *pair.first == opposite);
-        // if (pair.first != pair.second)
-        // {
-        //   // std::cout << "calling close to " << opposite << " found " << *pair.first << " with normal " << i << std::endl;
-        // }
-        // else
-        // {
-        //   std::cout << "not found opposite " << opposite << " from " << i  << std::endl;
-        //   // std::cout << "dumping actives:" << std::endl;
-        //   // for (auto&& a : actives)
-        //   // {
-        //   //   std::cout << "    active: " << a << std::endl;
-        //   // }
-        // }
-        // assert (pair.first != pair.second);
-      }
-      // assert(std::is_sorted (actives.begin(), actives.end(), compare));
       if (close (actives, i) == sweep_interrupt::break_)
         return sweep_interrupt::break_;
-      //std::cout << "actives now size " << actives.size() << std::endl;
-      //assert(std::is_sorted (actives.begin(), actives.end(), compare));
-      auto opposite = get_opposite_event(i);
-      auto pair = std::equal_range (actives.begin(), actives.end(), opposite, compare);
-      while (pair.first != pair.second && *pair.first != opposite)
-        ++pair.first;
-      assert (pair.first == pair.second || *pair.first == opposite);
-      if (pair.first != pair.second)
-      {
-        // std::cout << "erasing from actives " << *pair.first << " suppose to erase " << opposite << std::endl;
-        actives.erase (pair.first);
-      }
-      else
-        std::cout << "not found " << opposite << std::endl;
-      assert (pair.first != pair.second);
-      // assert(std::is_sorted (actives.begin(), actives.end(), compare));
+      bool erased = erase_active (actives, get_opposite_event(i));
+      assert (erased);
+      static_cast<void>(erased);
     }
- // assert(std::is_sorted (actives.begin(), actives.end(), compare));
     ++it;
   }
   return sweep_interrupt::continue_;
 }
-    
+
+// scan_events without the event container, for intervals that arrive
+// sorted by begin. The begin events come from [first, last) and the
+// end events from a min-heap of the intervals open, so memory follows
+// the intervals open at once instead of the input size and nothing is
+// sorted. When intervals that begin together are sorted by end, as
+// make_events would sort them, open and close are called exactly as
+// scan_events over make_events<Event> (first, last) calls them. open
+// may be nullptr.
+template <typename Event, typename ActiveContainer, typename InputIterator, typename Open, typename Close
+          , typename Trace = null_trace>
+void scan_intervals (ActiveContainer&& actives, InputIterator first, InputIterator last, Open&& open, Close&& close
+                     , Trace&& trace = Trace{})
+{
+  using algorithm::event_api::get_position;
+  using algorithm::event_api::get_opposite_event;
+  using algorithm::active_set_api::insert_active;
+  using algorithm::active_set_api::erase_active;
+  typedef typename Event::interval_type interval;
+
+  // end events with the order they were opened in, so ends at the same
+  // position close in input order as a stable sort leaves them
+  typedef std::pair<Event, std::size_t> pending;
+  auto later = [] (pending const& l, pending const& r)
+               {
+                 return get_position (r.first) < get_position (l.first)
+                   || (!(get_position (l.first) < get_position (r.first)) && r.second < l.second);
+               };
+  std::vector<pending> ends;
+  auto close_first = [&]
+                     {
+                       std::pop_heap (ends.begin(), ends.end(), later);
+                       Event e = ends.back().first;
+                       ends.pop_back();
+                       trace (trace_point::event, e);
+                       close (actives, e);
+                       bool erased = erase_active (actives, get_opposite_event (e));
+                       assert (erased);
+                       static_cast<void>(erased);
+                     };
+
+  std::size_t opened = 0;
+  Event previous {};
+  for (; first != last; ++first)
+  {
+    Event begin {event_type::begin, interval {*first}};
+    assert (opened == 0 || !(get_position (begin) < get_position (previous)));
+    previous = begin;
+    // end events sort after begin events at the same position
+    while (!ends.empty() && get_position (ends.front().first) < get_position (begin))
+      close_first ();
+    trace (trace_point::event, begin);
+    insert_active (actives, begin);
+    if constexpr (!std::is_same<typename std::decay<Open>::type, std::nullptr_t>::value)
+      open (actives, begin);
+    ends.push_back ({get_opposite_event (begin), opened++});
+    std::push_heap (ends.begin(), ends.end(), later);
+  }
+  while (!ends.empty())
+    close_first ();
+}
+
 } }
 
 #endif
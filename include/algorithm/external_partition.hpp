@@ -0,0 +1,358 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_EXTERNAL_PARTITION_HPP
+#define ALGORITHM_EXTERNAL_PARTITION_HPP
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/event_builder.hpp>
+#include <algorithm/file_io.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cassert>
+
+namespace exp { namespace algorithm {
+
+namespace detail {
+
+// $TMPDIR, or /tmp when it is not set
+inline std::string default_temporary_directory ()
+{
+  char const* directory = std::getenv ("TMPDIR");
+  return directory && *directory ? directory : "/tmp";
+}
+
+}
+
+struct external_partition_options
+{
+  // bytes for the sorted runs, the buffers of their merge and the
+  // output buffer, the open rectangles and the events the sweep adds
+  // ahead of itself are not counted
+  std::size_t memory_budget = std::size_t (64) << 20;
+  // where the runs are written, the files are unlinked as soon as they
+  // are created
+  std::string temporary_directory = detail::default_temporary_directory ();
+};
+
+struct external_partition_stats
+{
+  std::size_t rectangles = 0;
+  std::size_t runs = 0;
+  // merges of runs into longer runs before the last one, which feeds
+  // the sweep
+  std::size_t merge_passes = 0;
+  std::size_t fragments = 0;
+  // most events held by the sweep at once, added ahead and open
+  std::size_t peak_sweep_events = 0;
+};
+
+namespace detail {
+
+// A file nobody else can open, gone once it is closed
+inline file_descriptor temporary_file (std::string const& directory)
+{
+  std::string path = directory + "/partition-run-XXXXXX";
+  int fd = ::mkstemp (&path[0]);
+  if (fd == -1)
+    detail::throw_errno ("mkstemp");
+  ::unlink (path.c_str());
+  return file_descriptor (fd);
+}
+
+inline void write_all (int fd, void const* data, std::size_t bytes)
+{
+  auto p = static_cast<char const*>(data);
+  while (bytes != 0)
+  {
+    auto written = ::write (fd, p, bytes);
+    if (written == -1 && errno != EINTR)
+      detail::throw_errno ("write");
+    if (written > 0)
+    {
+      p += written;
+      bytes -= static_cast<std::size_t>(written);
+    }
+  }
+}
+
+inline void read_all (int fd, void* data, std::size_t bytes, off_t offset)
+{
+  auto p = static_cast<char*>(data);
+  while (bytes != 0)
+  {
+    auto read = ::pread (fd, p, bytes, offset);
+    if (read == -1 && errno != EINTR)
+      detail::throw_errno ("pread");
+    if (read == 0)
+      throw std::system_error (std::make_error_code (std::errc::io_error), "pread past the end of a run");
+    if (read > 0)
+    {
+      p += read;
+      offset += read;
+      bytes -= static_cast<std::size_t>(read);
+    }
+  }
+}
+
+// Values appended to a file through a buffer, flush writes the rest
+template <typename T>
+class buffered_writer
+{
+public:
+  buffered_writer (int fd, std::size_t buffer_size)
+    : fd (fd)
+  {
+    buffer.reserve (std::max<std::size_t> (buffer_size, 1));
+  }
+
+  void push_back (T const& value)
+  {
+    buffer.push_back (value);
+    if (buffer.size() == buffer.capacity())
+      flush ();
+  }
+
+  void flush ()
+  {
+    detail::write_all (fd, buffer.data(), buffer.size() * sizeof (T));
+    buffer.clear();
+  }
+
+private:
+  int fd;
+  std::vector<T> buffer;
+};
+
+// A run of count values at offset in a file, read through a buffer
+template <typename T>
+class run_reader
+{
+public:
+  run_reader (int fd, off_t offset, std::size_t count, std::size_t buffer_size)
+    : fd (fd), offset (offset), left (count), buffer (std::max<std::size_t> (buffer_size, 1))
+  {
+    refill ();
+  }
+
+  bool empty () const { return at == size; }
+  T const& front () const { return buffer[at]; }
+  void pop ()
+  {
+    if (++at == size)
+      refill ();
+  }
+
+private:
+  void refill ()
+  {
+    size = std::min (left, buffer.size());
+    at = 0;
+    if (size == 0)
+      return;
+    detail::read_all (fd, buffer.data(), size * sizeof (T), offset);
+    offset += static_cast<off_t>(size * sizeof (T));
+    left -= size;
+  }
+
+  int fd;
+  off_t offset;
+  std::size_t left;
+  std::vector<T> buffer;
+  std::size_t at = 0, size = 0;
+};
+
+struct run
+{
+  off_t offset;
+  std::size_t count;
+};
+
+// Merges runs of the events in fd, calling f for every event in order.
+// Equivalent events come from the earlier run first, so merging the
+// sorted runs of consecutive chunks gives what a stable sort of the
+// whole gives.
+template <typename Event, typename F>
+void merge_runs (int fd, std::vector<run> const& runs, std::size_t buffer_bytes, F&& f)
+{
+  std::vector<run_reader<Event>> readers;
+  readers.reserve (runs.size());
+  std::size_t const buffer_size = std::max<std::size_t> (buffer_bytes / sizeof (Event) / std::max<std::size_t> (runs.size(), 1), 1);
+  for (auto&& r : runs)
+    readers.emplace_back (fd, r.offset, r.count, buffer_size);
+
+  auto later = [&] (std::size_t l, std::size_t r)
+               {
+                 return readers[r].front() < readers[l].front()
+                   || (!(readers[l].front() < readers[r].front()) && r < l);
+               };
+  std::vector<std::size_t> heap;
+  for (std::size_t i = 0; i != readers.size(); ++i)
+    if (!readers[i].empty())
+      heap.push_back (i);
+  std::make_heap (heap.begin(), heap.end(), later);
+  while (!heap.empty())
+  {
+    std::pop_heap (heap.begin(), heap.end(), later);
+    auto& reader = readers[heap.back()];
+    f (reader.front());
+    reader.pop();
+    if (reader.empty())
+      heap.pop_back();
+    else
+      std::push_heap (heap.begin(), heap.end(), later);
+  }
+}
+
+}
+
+// rectangle_partition for inputs that do not fit in memory. The input
+// file holds the rectangles as a plain array of Rectangle, which must
+// copy as bytes, and the fragments are written to output the
+// same way, in the order rectangle_partition returns them. Failures to
+// read or write throw std::system_error.
+//
+// The input is mapped and read once in chunks, each chunk's begin
+// events sorted and written as a run to a temporary file. Runs are
+// merged, several at a time when there are more than the budget can
+// buffer, and the last merge feeds the sweep directly: the sweep takes
+// the next event from the merge or from the events it added ahead of
+// itself, whichever comes first, so it holds only the rectangles open
+// at its position and what they leave ahead. Fragments are written as
+// they close.
+template <typename Rectangle, typename Trace = null_trace>
+external_partition_stats external_rectangle_partition (char const* input, char const* output
+                                                       , external_partition_options const& options = {}
+                                                       , Trace&& trace = Trace{})
+{
+  // std::pair has its own assignment, but copies and destroys as bytes
+  static_assert (std::is_trivially_copy_constructible<Rectangle>::value && std::is_trivially_destructible<Rectangle>::value
+                 , "rectangles are read and written as bytes");
+  typedef detail::interval_n<Rectangle, 0> interval0;
+  typedef event<interval0> event0;
+  using algorithm::event_api::is_begin_event;
+
+  external_partition_stats stats;
+  std::size_t const budget = std::max<std::size_t> (options.memory_budget, 4096);
+
+  // sorted runs of the begin events, chunks of half the budget since
+  // the radix sort needs as much again
+  detail::mapped_file in (input);
+  stats.rectangles = in.size() / sizeof (Rectangle);
+  auto rects = static_cast<Rectangle const*>(in.data());
+  auto runs_file = detail::temporary_file (options.temporary_directory);
+  std::vector<detail::run> runs;
+  {
+    std::size_t const chunk = std::max<std::size_t> (budget / 2 / sizeof (event0), 1);
+    std::vector<event0> begins, scratch;
+    off_t offset = 0;
+    for (std::size_t first = 0; first < stats.rectangles; first += chunk)
+    {
+      begins.clear();
+      std::size_t const last = std::min (first + chunk, stats.rectangles);
+      for (std::size_t i = first; i != last; ++i)
+      {
+        auto const& r = rects[i];
+        if (detail::rget_x1 (r) < detail::rget_x2 (r) && detail::rget_y1 (r) < detail::rget_y2 (r))
+          begins.push_back ({event_type::begin, {r}});
+      }
+      in.release (last * sizeof (Rectangle));
+      if (begins.empty())
+        continue;
+      algorithm::sort_events (begins, scratch);
+      detail::write_all (runs_file.get(), begins.data(), begins.size() * sizeof (event0));
+      runs.push_back ({offset, begins.size()});
+      offset += static_cast<off_t>(begins.size() * sizeof (event0));
+    }
+  }
+  stats.runs = runs.size();
+
+  // half the budget buffers a merge, no less than a page per run
+  std::size_t const merge_bytes = budget / 2;
+  std::size_t const fan_in = std::max<std::size_t> (merge_bytes / 4096, 2);
+  while (runs.size() > fan_in)
+  {
+    auto merged_file = detail::temporary_file (options.temporary_directory);
+    std::vector<detail::run> merged;
+    off_t offset = 0;
+    for (std::size_t first = 0; first < runs.size(); first += fan_in)
+    {
+      std::vector<detail::run> group (runs.begin() + first, runs.begin() + std::min (first + fan_in, runs.size()));
+      std::size_t count = 0;
+      {
+        detail::buffered_writer<event0> writer (merged_file.get(), merge_bytes / 2 / sizeof (event0));
+        detail::merge_runs<event0> (runs_file.get(), group, merge_bytes / 2
+                                    , [&] (event0 const& e) { writer.push_back (e); ++count; });
+        writer.flush();
+      }
+      merged.push_back ({offset, count});
+      offset += static_cast<off_t>(count * sizeof (event0));
+    }
+    runs_file = std::move (merged_file);
+    runs.swap (merged);
+    ++stats.merge_passes;
+  }
+
+  detail::file_descriptor out (::open (output, O_WRONLY | O_CREAT | O_TRUNC, 0644));
+  if (out.get() == -1)
+    detail::throw_errno ("open");
+  detail::buffered_writer<Rectangle> fragments (out.get(), budget / 4 / sizeof (Rectangle));
+
+  // the events added ahead come after the equivalent ones of the
+  // input, as btree_multiset::insert puts them in rectangle_partition.
+  // They are taken from the front as they are swept, which
+  // btree_multiset pays for by keeping its emptied leaves.
+  std::multiset<event0> ahead;
+  detail::open_set<event0> open_0;
+  std::vector<Rectangle> pieces, scratch;
+  auto sweep_until = [&] (event0 const* next)
+                     {
+                       while (!ahead.empty() && (next == nullptr || *ahead.begin() < *next))
+                       {
+                         event0 e = *ahead.begin();
+                         ahead.erase (ahead.begin());
+                         trace (trace_point::event, e.interval.rectangle);
+                         if (is_begin_event (e))
+                           detail::handle_open_0 (open_0, e, ahead, pieces, scratch, trace);
+                         else
+                         {
+                           fragments.push_back (detail::handle_close_0 (open_0, e, trace));
+                           ++stats.fragments;
+                         }
+                         stats.peak_sweep_events = std::max (stats.peak_sweep_events, ahead.size() + open_0.size());
+                       }
+                     };
+  detail::merge_runs<event0> (runs_file.get(), runs, merge_bytes / 2
+                              , [&] (event0 const& e)
+                                {
+                                  sweep_until (&e);
+                                  trace (trace_point::event, e.interval.rectangle);
+                                  detail::handle_open_0 (open_0, e, ahead, pieces, scratch, trace);
+                                  stats.peak_sweep_events = std::max (stats.peak_sweep_events, ahead.size() + open_0.size());
+                                });
+  sweep_until (nullptr);
+  assert (open_0.empty());
+  fragments.flush();
+  return stats;
+}
+
+} }
+
+#endif
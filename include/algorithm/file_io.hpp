@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_FILE_IO_HPP
+#define ALGORITHM_FILE_IO_HPP
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <system_error>
+#include <utility>
+
+namespace exp { namespace algorithm { namespace detail {
+
+[[noreturn]] inline void throw_errno (char const* what)
+{
+  throw std::system_error (errno, std::generic_category(), what);
+}
+
+class file_descriptor
+{
+public:
+  explicit file_descriptor (int fd = -1) : fd (fd) {}
+  file_descriptor (file_descriptor&& other) : fd (other.fd) { other.fd = -1; }
+  file_descriptor& operator= (file_descriptor&& other)
+  {
+    std::swap (fd, other.fd);
+    return *this;
+  }
+  ~file_descriptor ()
+  {
+    if (fd != -1)
+      ::close (fd);
+  }
+
+  int get () const { return fd; }
+
+private:
+  int fd;
+};
+
+// A whole file mapped read only, for reading once from the start
+class mapped_file
+{
+public:
+  explicit mapped_file (char const* path)
+    : fd (::open (path, O_RDONLY))
+  {
+    if (fd.get() == -1)
+      detail::throw_errno ("open");
+    struct stat st;
+    if (::fstat (fd.get(), &st) == -1)
+      detail::throw_errno ("fstat");
+    bytes = static_cast<std::size_t>(st.st_size);
+    if (bytes == 0)
+      return;
+    data_ = ::mmap (nullptr, bytes, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (data_ == MAP_FAILED)
+      detail::throw_errno ("mmap");
+    ::madvise (data_, bytes, MADV_SEQUENTIAL);
+  }
+  mapped_file (mapped_file const&) = delete;
+  mapped_file& operator= (mapped_file const&) = delete;
+  ~mapped_file ()
+  {
+    if (bytes != 0)
+      ::munmap (data_, bytes);
+  }
+
+  void const* data () const { return data_; }
+  std::size_t size () const { return bytes; }
+
+  // drops the pages of [0, end) from the resident set
+  void release (std::size_t end)
+  {
+    std::size_t const page = static_cast<std::size_t>(::sysconf (_SC_PAGESIZE));
+    end = end / page * page;
+    if (end > released)
+    {
+      ::madvise (static_cast<char*>(data_) + released, end - released, MADV_DONTNEED);
+      released = end;
+    }
+  }
+
+private:
+  file_descriptor fd;
+  void* data_ = nullptr;
+  std::size_t bytes = 0;
+  std::size_t released = 0;
+};
+
+} } }
+
+#endif
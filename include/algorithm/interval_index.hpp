@@ -0,0 +1,233 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_INTERVAL_INDEX_HPP
+#define ALGORITHM_INTERVAL_INDEX_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <cassert>
+
+namespace exp { namespace algorithm {
+
+// Dynamic set of half-open intervals [begin, end), each one tagged by
+// an id, that finds the intervals overlapping a query interval without
+// looking at the others. The intervals are kept in a treap ordered by
+// (begin, id) where every node also keeps the greatest end in its
+// subtree, so a query skips whole subtrees that end before it and
+// stops at the first begin after it. A query costs about
+// log(size) for every interval it reports, whatever the widths of the
+// intervals are, where a window bounded by the widest interval can
+// degrade to a scan of everything that begins before the query.
+//
+// Nodes are kept in one vector and reused after erase, so insert and
+// erase do not allocate once the index has grown to its size. The
+// (begin, id) pairs must be unique.
+template <typename Position>
+class interval_index
+{
+public:
+  typedef Position position_type;
+  typedef std::size_t size_type;
+
+  size_type size () const { return count; }
+  bool empty () const { return count == 0; }
+
+  void insert (Position begin, Position end, std::size_t id)
+  {
+    std::size_t n;
+    if (free_nodes.empty())
+    {
+      n = nodes.size();
+      nodes.push_back ({});
+    }
+    else
+    {
+      n = free_nodes.back();
+      free_nodes.pop_back();
+    }
+    nodes[n] = {begin, end, end, id, next_priority(), npos, npos};
+    auto parts = split (root, begin, id);
+    root = merge (merge (parts.first, n), parts.second);
+    ++count;
+  }
+
+  // Erases the interval with this begin and id, returns false if
+  // there is none
+  bool erase (Position begin, std::size_t id)
+  {
+    std::size_t before = count;
+    root = erase (root, begin, id);
+    return count != before;
+  }
+
+  void clear ()
+  {
+    nodes.clear();
+    free_nodes.clear();
+    root = npos;
+    count = 0;
+  }
+
+  // Calls f (id) for every interval that overlaps [begin, end), in
+  // order of (begin, id), until f returns false. Returns false if f
+  // did.
+  template <typename F>
+  bool for_each_overlap (Position begin, Position end, F&& f) const
+  {
+    return overlaps (root, begin, end, f);
+  }
+
+  // Calls f (id) for every interval that begins at begin, in order of
+  // id, until f returns false. Returns false if f did. Unlike
+  // for_each_overlap it also finds empty intervals.
+  template <typename F>
+  bool for_each_at (Position begin, F&& f) const
+  {
+    return at (root, begin, f);
+  }
+
+private:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  struct node
+  {
+    Position begin, end;
+    // greatest end in the subtree
+    Position max_end;
+    std::size_t id;
+    std::uint32_t priority;
+    std::size_t left, right;
+  };
+
+  static bool less (node const& n, Position begin, std::size_t id)
+  {
+    return n.begin < begin || (!(begin < n.begin) && n.id < id);
+  }
+
+  std::uint32_t next_priority ()
+  {
+    // xorshift32, the treap only needs the priorities to be unrelated
+    // to the order of the keys
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+  }
+
+  void update (std::size_t n)
+  {
+    auto& v = nodes[n];
+    v.max_end = v.end;
+    if (v.left != npos && v.max_end < nodes[v.left].max_end)
+      v.max_end = nodes[v.left].max_end;
+    if (v.right != npos && v.max_end < nodes[v.right].max_end)
+      v.max_end = nodes[v.right].max_end;
+  }
+
+  // splits t in the nodes ordered before (begin, id) and the others
+  std::pair<std::size_t, std::size_t> split (std::size_t t, Position begin, std::size_t id)
+  {
+    if (t == npos)
+      return {npos, npos};
+    if (less (nodes[t], begin, id))
+    {
+      auto parts = split (nodes[t].right, begin, id);
+      nodes[t].right = parts.first;
+      update (t);
+      return {t, parts.second};
+    }
+    auto parts = split (nodes[t].left, begin, id);
+    nodes[t].left = parts.second;
+    update (t);
+    return {parts.first, t};
+  }
+
+  // every node of l is ordered before every node of r
+  std::size_t merge (std::size_t l, std::size_t r)
+  {
+    if (l == npos)
+      return r;
+    if (r == npos)
+      return l;
+    if (nodes[r].priority < nodes[l].priority)
+    {
+      nodes[l].right = merge (nodes[l].right, r);
+      update (l);
+      return l;
+    }
+    nodes[r].left = merge (l, nodes[r].left);
+    update (r);
+    return r;
+  }
+
+  std::size_t erase (std::size_t t, Position begin, std::size_t id)
+  {
+    if (t == npos)
+      return npos;
+    auto& v = nodes[t];
+    if (v.id == id && !(v.begin < begin) && !(begin < v.begin))
+    {
+      auto replacement = merge (v.left, v.right);
+      free_nodes.push_back (t);
+      --count;
+      return replacement;
+    }
+    if (less (v, begin, id))
+      nodes[t].right = erase (v.right, begin, id);
+    else
+      nodes[t].left = erase (v.left, begin, id);
+    update (t);
+    return t;
+  }
+
+  template <typename F>
+  bool overlaps (std::size_t t, Position begin, Position end, F& f) const
+  {
+    if (t == npos)
+      return true;
+    auto const& v = nodes[t];
+    // nothing under t ends after begin
+    if (!(begin < v.max_end))
+      return true;
+    if (!overlaps (v.left, begin, end, f))
+      return false;
+    // v and everything to its right begin at or after end
+    if (!(v.begin < end))
+      return true;
+    if (begin < v.end && !f (v.id))
+      return false;
+    return overlaps (v.right, begin, end, f);
+  }
+
+  template <typename F>
+  bool at (std::size_t t, Position begin, F& f) const
+  {
+    if (t == npos)
+      return true;
+    auto const& v = nodes[t];
+    if (v.begin < begin)
+      return at (v.right, begin, f);
+    if (begin < v.begin)
+      return at (v.left, begin, f);
+    return at (v.left, begin, f) && f (v.id) && at (v.right, begin, f);
+  }
+
+  std::vector<node> nodes;
+  std::vector<std::size_t> free_nodes;
+  std::size_t root = npos;
+  size_type count = 0;
+  std::uint32_t seed = 2463534242u;
+};
+
+} }
+
+#endif
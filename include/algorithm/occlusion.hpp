@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_OCCLUSION_HPP
+#define ALGORITHM_OCCLUSION_HPP
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/split_rectangles.hpp>
+#include <algorithm/interval_index.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace exp { namespace algorithm {
+
+// The visible fragments of every input of occlusion_partition, grouped
+// by input in input order
+template <typename Rectangle>
+struct visible_fragments
+{
+  std::vector<Rectangle> fragments;
+  // the fragments of input i are [offsets[i], offsets[i + 1])
+  std::vector<std::size_t> offsets;
+
+  // number of inputs
+  std::size_t size () const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+  std::span<Rectangle const> of (std::size_t input) const
+  {
+    return {fragments.data() + offsets[input], offsets[input + 1] - offsets[input]};
+  }
+};
+
+// Partitions opaque layers: rects[i] is drawn at depth z[i], greater is
+// above, and each input keeps only the disjoint fragments of it that
+// no input above it covers. Of inputs at the same depth the first one
+// is above. Together the fragments cover the union of the inputs once,
+// so a renderer that draws them draws every pixel once.
+//
+// Inputs are placed from the top down, each one split by the inputs
+// already placed that overlap it, which are found by their interval in
+// dim-0 in an interval_index as in dynamic_rectangle_partition, so a
+// wide layer on top costs only the inputs it overlaps. A split stops
+// as soon as nothing of the input is left, so a deeply occluded input
+// costs about the inputs over it.
+template <typename Container, typename ZContainer>
+visible_fragments<typename Container::value_type> occlusion_partition (Container const& rects, ZContainer const& z)
+{
+  typedef typename Container::value_type rectangle;
+  typedef typename detail::rectangle_position<rectangle>::type position;
+  std::vector<rectangle> inputs (std::begin (rects), std::end (rects));
+  assert (inputs.size() == static_cast<std::size_t>(std::distance (std::begin (z), std::end (z))));
+
+  std::vector<std::size_t> order (inputs.size());
+  std::iota (order.begin(), order.end(), std::size_t (0));
+  auto depth = std::begin (z);
+  std::stable_sort (order.begin(), order.end()
+                    , [&] (std::size_t l, std::size_t r) { return depth[r] < depth[l]; });
+
+  // the dim-0 interval of the inputs placed so far
+  interval_index<position> placed;
+  // the fragments of each input, in the order inputs are placed
+  std::vector<std::pair<std::size_t, rectangle>> found;
+  std::vector<rectangle> pieces, scratch;
+  for (auto i : order)
+  {
+    auto const& r = inputs[i];
+    if (!(detail::rget_x1 (r) < detail::rget_x2 (r) && detail::rget_y1 (r) < detail::rget_y2 (r)))
+      continue;
+    pieces.clear();
+    pieces.push_back (r);
+    placed.for_each_overlap (detail::rget_x1 (r), detail::rget_x2 (r), [&] (std::size_t j)
+                             {
+                               auto const& above = inputs[j];
+                               return !detail::rectangles_overlap (above, r)
+                                 || !detail::split_pieces (above, pieces, scratch, null_trace{});
+                             });
+    for (auto&& piece : pieces)
+      found.push_back ({i, piece});
+    placed.insert (detail::rget_x1 (r), detail::rget_x2 (r), i);
+  }
+
+  // grouped by input with a counting pass
+  visible_fragments<rectangle> visible;
+  visible.offsets.assign (inputs.size() + 1, 0);
+  for (auto&& f : found)
+    ++visible.offsets[f.first + 1];
+  std::partial_sum (visible.offsets.begin(), visible.offsets.end(), visible.offsets.begin());
+  visible.fragments.resize (found.size());
+  std::vector<std::size_t> next (visible.offsets.begin(), visible.offsets.end() - 1);
+  for (auto&& f : found)
+    visible.fragments[next[f.first]++] = f.second;
+  return visible;
+}
+
+} }
+
+#endif
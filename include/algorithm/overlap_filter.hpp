@@ -0,0 +1,449 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_OVERLAP_FILTER_HPP
+#define ALGORITHM_OVERLAP_FILTER_HPP
+
+#include <algorithm/interval.hpp>
+#include <algorithm/rectangle.hpp>
+#include <algorithm/split_rectangles.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define ALGORITHM_OVERLAP_FILTER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace exp { namespace algorithm {
+
+// Coordinates of a sequence of rectangles as four arrays, so a query
+// can test many of them per instruction.
+template <typename Position, typename Allocator = std::allocator<Position>>
+class soa_rectangles
+{
+public:
+  typedef Position position_type;
+  typedef Allocator allocator_type;
+
+  soa_rectangles () = default;
+  explicit soa_rectangles (Allocator const& allocator)
+    : x1_ (allocator), x2_ (allocator), y1_ (allocator), y2_ (allocator) {}
+
+  std::size_t size () const { return x1_.size(); }
+  bool empty () const { return x1_.empty(); }
+
+  Position const* x1 () const { return x1_.data(); }
+  Position const* x2 () const { return x2_.data(); }
+  Position const* y1 () const { return y1_.data(); }
+  Position const* y2 () const { return y2_.data(); }
+  Position* x1 () { return x1_.data(); }
+  Position* x2 () { return x2_.data(); }
+  Position* y1 () { return y1_.data(); }
+  Position* y2 () { return y2_.data(); }
+
+  template <typename Rectangle>
+  void insert (std::size_t index, Rectangle const& r)
+  {
+    x1_.insert (x1_.begin() + index, detail::rget_x1 (r));
+    x2_.insert (x2_.begin() + index, detail::rget_x2 (r));
+    y1_.insert (y1_.begin() + index, detail::rget_y1 (r));
+    y2_.insert (y2_.begin() + index, detail::rget_y2 (r));
+  }
+
+  template <typename Rectangle>
+  void push_back (Rectangle const& r)
+  {
+    insert (size(), r);
+  }
+
+  void erase (std::size_t index)
+  {
+    x1_.erase (x1_.begin() + index);
+    x2_.erase (x2_.begin() + index);
+    y1_.erase (y1_.begin() + index);
+    y2_.erase (y2_.begin() + index);
+  }
+
+  void reserve (std::size_t n)
+  {
+    x1_.reserve (n);
+    x2_.reserve (n);
+    y1_.reserve (n);
+    y2_.reserve (n);
+  }
+
+  void resize (std::size_t n)
+  {
+    x1_.resize (n);
+    x2_.resize (n);
+    y1_.resize (n);
+    y2_.resize (n);
+  }
+
+  void swap (soa_rectangles& other)
+  {
+    x1_.swap (other.x1_);
+    x2_.swap (other.x2_);
+    y1_.swap (other.y1_);
+    y2_.swap (other.y2_);
+  }
+
+  void clear ()
+  {
+    x1_.clear();
+    x2_.clear();
+    y1_.clear();
+    y2_.clear();
+  }
+
+private:
+  typedef std::vector<Position, typename std::allocator_traits<Allocator>::template rebind_alloc<Position>> array;
+  array x1_, x2_, y1_, y2_;
+};
+
+// Instruction sets of the overlap kernels, each one needing the ones
+// before it
+enum class simd_level { scalar, sse4_2, avx2, avx512 };
+
+// The best level the running CPU supports, detected once
+inline simd_level detected_simd_level ()
+{
+#ifdef ALGORITHM_OVERLAP_FILTER_X86
+  static simd_level const level = []
+  {
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx512f"))
+      return simd_level::avx512;
+    if (__builtin_cpu_supports ("avx2"))
+      return simd_level::avx2;
+    if (__builtin_cpu_supports ("sse4.2"))
+      return simd_level::sse4_2;
+    return simd_level::scalar;
+  } ();
+  return level;
+#else
+  return simd_level::scalar;
+#endif
+}
+
+namespace detail {
+
+// Bit i of masks[i / 64] is set when rectangle i overlaps the query,
+// with the same test as rectangles_overlap. The kernels write whole
+// masks, the tail is done by the scalar kernel.
+template <typename Position, typename A>
+void overlap_masks_scalar (soa_rectangles<Position, A> const& rects, std::size_t first
+                           , Position qx1, Position qx2, Position qy1, Position qy2
+                           , std::uint64_t* masks)
+{
+  auto x1 = rects.x1(), x2 = rects.x2(), y1 = rects.y1(), y2 = rects.y2();
+  for (std::size_t i = first; i != rects.size(); ++i)
+  {
+    bool overlap = qx1 < x2[i] && qy1 < y2[i] && x1[i] < qx2 && y1[i] < qy2;
+    masks[i / 64] |= std::uint64_t (overlap) << (i % 64);
+  }
+}
+
+// integral positions the kernels compare as 32 or 64 bit signed lanes,
+// unsigned ones after flipping the sign bit
+template <typename Position>
+struct simd_position
+  : std::integral_constant<bool, std::is_integral<Position>::value
+                           && (sizeof (Position) == 4 || sizeof (Position) == 8)> {};
+
+// the position to mirror Position as so the kernels take it, 8 and 16
+// bit integers are widened to int
+template <typename Position>
+struct simd_mirror_position
+{
+  typedef decltype (+std::declval<Position>()) type;
+};
+
+#ifdef ALGORITHM_OVERLAP_FILTER_X86
+
+template <typename Position>
+constexpr long long sign_flip ()
+{
+  return std::is_signed<Position>::value ? 0
+    : sizeof (Position) == 4 ? static_cast<long long>(0x80000000ll) : static_cast<long long>(0x8000000000000000ull);
+}
+
+// loads with the sign bit flipped and signed compares, one set per
+// instruction set, so the kernels can inline them
+template <typename Position>
+__attribute__ ((target ("sse4.2")))
+inline __m128i load_128 (Position const* p, __m128i flip)
+{
+  return _mm_xor_si128 (_mm_loadu_si128 (reinterpret_cast<__m128i const*>(p)), flip);
+}
+
+template <typename Position>
+__attribute__ ((target ("sse4.2")))
+inline __m128i greater_128 (__m128i l, __m128i r)
+{
+  if constexpr (sizeof (Position) == 4)
+    return _mm_cmpgt_epi32 (l, r);
+  else
+    return _mm_cmpgt_epi64 (l, r);
+}
+
+template <typename Position>
+__attribute__ ((target ("avx2")))
+inline __m256i load_256 (Position const* p, __m256i flip)
+{
+  return _mm256_xor_si256 (_mm256_loadu_si256 (reinterpret_cast<__m256i const*>(p)), flip);
+}
+
+template <typename Position>
+__attribute__ ((target ("avx2")))
+inline __m256i greater_256 (__m256i l, __m256i r)
+{
+  if constexpr (sizeof (Position) == 4)
+    return _mm256_cmpgt_epi32 (l, r);
+  else
+    return _mm256_cmpgt_epi64 (l, r);
+}
+
+template <typename Position>
+__attribute__ ((target ("avx512f")))
+inline __m512i load_512 (Position const* p, __m512i flip)
+{
+  return _mm512_xor_si512 (_mm512_loadu_si512 (p), flip);
+}
+
+template <typename Position, typename A>
+__attribute__ ((target ("sse4.2")))
+std::size_t overlap_masks_sse4_2 (soa_rectangles<Position, A> const& rects
+                                  , Position qx1, Position qx2, Position qy1, Position qy2
+                                  , std::uint64_t* masks)
+{
+  constexpr std::size_t lanes = 16 / sizeof (Position);
+  auto x1 = rects.x1(), x2 = rects.x2(), y1 = rects.y1(), y2 = rects.y2();
+  __m128i flip, vx1, vx2, vy1, vy2;
+  if constexpr (sizeof (Position) == 4)
+  {
+    flip = _mm_set1_epi32 (static_cast<int>(sign_flip<Position>()));
+    vx1 = _mm_set1_epi32 (static_cast<int>(qx1));
+    vx2 = _mm_set1_epi32 (static_cast<int>(qx2));
+    vy1 = _mm_set1_epi32 (static_cast<int>(qy1));
+    vy2 = _mm_set1_epi32 (static_cast<int>(qy2));
+  }
+  else
+  {
+    flip = _mm_set1_epi64x (sign_flip<Position>());
+    vx1 = _mm_set1_epi64x (static_cast<long long>(qx1));
+    vx2 = _mm_set1_epi64x (static_cast<long long>(qx2));
+    vy1 = _mm_set1_epi64x (static_cast<long long>(qy1));
+    vy2 = _mm_set1_epi64x (static_cast<long long>(qy2));
+  }
+  vx1 = _mm_xor_si128 (vx1, flip);
+  vx2 = _mm_xor_si128 (vx2, flip);
+  vy1 = _mm_xor_si128 (vy1, flip);
+  vy2 = _mm_xor_si128 (vy2, flip);
+
+  std::size_t const whole = rects.size() / 64 * 64;
+  for (std::size_t block = 0; block != whole; block += 64)
+  {
+    std::uint64_t mask = 0;
+    for (std::size_t i = 0; i != 64; i += lanes)
+    {
+      auto j = block + i;
+      __m128i overlap = _mm_and_si128
+        (_mm_and_si128 (greater_128<Position> (load_128 (x2 + j, flip), vx1)
+                        , greater_128<Position> (load_128 (y2 + j, flip), vy1))
+         , _mm_and_si128 (greater_128<Position> (vx2, load_128 (x1 + j, flip))
+                          , greater_128<Position> (vy2, load_128 (y1 + j, flip))));
+      std::uint64_t bits = sizeof (Position) == 4
+        ? _mm_movemask_ps (_mm_castsi128_ps (overlap))
+        : _mm_movemask_pd (_mm_castsi128_pd (overlap));
+      mask |= bits << i;
+    }
+    masks[block / 64] = mask;
+  }
+  return whole;
+}
+
+template <typename Position, typename A>
+__attribute__ ((target ("avx2")))
+std::size_t overlap_masks_avx2 (soa_rectangles<Position, A> const& rects
+                                , Position qx1, Position qx2, Position qy1, Position qy2
+                                , std::uint64_t* masks)
+{
+  constexpr std::size_t lanes = 32 / sizeof (Position);
+  auto x1 = rects.x1(), x2 = rects.x2(), y1 = rects.y1(), y2 = rects.y2();
+  __m256i flip, vx1, vx2, vy1, vy2;
+  if constexpr (sizeof (Position) == 4)
+  {
+    flip = _mm256_set1_epi32 (static_cast<int>(sign_flip<Position>()));
+    vx1 = _mm256_set1_epi32 (static_cast<int>(qx1));
+    vx2 = _mm256_set1_epi32 (static_cast<int>(qx2));
+    vy1 = _mm256_set1_epi32 (static_cast<int>(qy1));
+    vy2 = _mm256_set1_epi32 (static_cast<int>(qy2));
+  }
+  else
+  {
+    flip = _mm256_set1_epi64x (sign_flip<Position>());
+    vx1 = _mm256_set1_epi64x (static_cast<long long>(qx1));
+    vx2 = _mm256_set1_epi64x (static_cast<long long>(qx2));
+    vy1 = _mm256_set1_epi64x (static_cast<long long>(qy1));
+    vy2 = _mm256_set1_epi64x (static_cast<long long>(qy2));
+  }
+  vx1 = _mm256_xor_si256 (vx1, flip);
+  vx2 = _mm256_xor_si256 (vx2, flip);
+  vy1 = _mm256_xor_si256 (vy1, flip);
+  vy2 = _mm256_xor_si256 (vy2, flip);
+
+  std::size_t const whole = rects.size() / 64 * 64;
+  for (std::size_t block = 0; block != whole; block += 64)
+  {
+    std::uint64_t mask = 0;
+    for (std::size_t i = 0; i != 64; i += lanes)
+    {
+      auto j = block + i;
+      __m256i overlap = _mm256_and_si256
+        (_mm256_and_si256 (greater_256<Position> (load_256 (x2 + j, flip), vx1)
+                           , greater_256<Position> (load_256 (y2 + j, flip), vy1))
+         , _mm256_and_si256 (greater_256<Position> (vx2, load_256 (x1 + j, flip))
+                             , greater_256<Position> (vy2, load_256 (y1 + j, flip))));
+      std::uint64_t bits = static_cast<unsigned>(sizeof (Position) == 4
+                                                 ? _mm256_movemask_ps (_mm256_castsi256_ps (overlap))
+                                                 : _mm256_movemask_pd (_mm256_castsi256_pd (overlap)));
+      mask |= bits << i;
+    }
+    masks[block / 64] = mask;
+  }
+  return whole;
+}
+
+template <typename Position, typename A>
+__attribute__ ((target ("avx512f")))
+std::size_t overlap_masks_avx512 (soa_rectangles<Position, A> const& rects
+                                  , Position qx1, Position qx2, Position qy1, Position qy2
+                                  , std::uint64_t* masks)
+{
+  constexpr std::size_t lanes = 64 / sizeof (Position);
+  auto x1 = rects.x1(), x2 = rects.x2(), y1 = rects.y1(), y2 = rects.y2();
+  __m512i flip, vx1, vx2, vy1, vy2;
+  if constexpr (sizeof (Position) == 4)
+  {
+    flip = _mm512_set1_epi32 (static_cast<int>(sign_flip<Position>()));
+    vx1 = _mm512_set1_epi32 (static_cast<int>(qx1));
+    vx2 = _mm512_set1_epi32 (static_cast<int>(qx2));
+    vy1 = _mm512_set1_epi32 (static_cast<int>(qy1));
+    vy2 = _mm512_set1_epi32 (static_cast<int>(qy2));
+  }
+  else
+  {
+    flip = _mm512_set1_epi64 (sign_flip<Position>());
+    vx1 = _mm512_set1_epi64 (static_cast<long long>(qx1));
+    vx2 = _mm512_set1_epi64 (static_cast<long long>(qx2));
+    vy1 = _mm512_set1_epi64 (static_cast<long long>(qy1));
+    vy2 = _mm512_set1_epi64 (static_cast<long long>(qy2));
+  }
+  vx1 = _mm512_xor_si512 (vx1, flip);
+  vx2 = _mm512_xor_si512 (vx2, flip);
+  vy1 = _mm512_xor_si512 (vy1, flip);
+  vy2 = _mm512_xor_si512 (vy2, flip);
+
+  std::size_t const whole = rects.size() / 64 * 64;
+  for (std::size_t block = 0; block != whole; block += 64)
+  {
+    std::uint64_t mask = 0;
+    for (std::size_t i = 0; i != 64; i += lanes)
+    {
+      auto j = block + i;
+      std::uint64_t bits;
+      // each compare is masked by the ones before it
+      if constexpr (sizeof (Position) == 4)
+      {
+        __mmask16 m = _mm512_cmpgt_epi32_mask (load_512 (x2 + j, flip), vx1);
+        m = _mm512_mask_cmpgt_epi32_mask (m, load_512 (y2 + j, flip), vy1);
+        m = _mm512_mask_cmpgt_epi32_mask (m, vx2, load_512 (x1 + j, flip));
+        bits = _mm512_mask_cmpgt_epi32_mask (m, vy2, load_512 (y1 + j, flip));
+      }
+      else
+      {
+        __mmask8 m = _mm512_cmpgt_epi64_mask (load_512 (x2 + j, flip), vx1);
+        m = _mm512_mask_cmpgt_epi64_mask (m, load_512 (y2 + j, flip), vy1);
+        m = _mm512_mask_cmpgt_epi64_mask (m, vx2, load_512 (x1 + j, flip));
+        bits = _mm512_mask_cmpgt_epi64_mask (m, vy2, load_512 (y1 + j, flip));
+      }
+      mask |= bits << i;
+    }
+    masks[block / 64] = mask;
+  }
+  return whole;
+}
+
+#endif
+
+}
+
+// Fills masks with one bit per rectangle of rects, set when it
+// overlaps query, using the kernel of level. masks is resized to
+// (rects.size() + 63) / 64 words.
+template <typename Position, typename A, typename Rectangle, typename MaskAllocator>
+void overlap_masks (soa_rectangles<Position, A> const& rects, Rectangle const& query
+                    , std::vector<std::uint64_t, MaskAllocator>& masks, simd_level level)
+{
+  masks.assign ((rects.size() + 63) / 64, 0);
+  Position qx1 = detail::rget_x1 (query), qx2 = detail::rget_x2 (query)
+    , qy1 = detail::rget_y1 (query), qy2 = detail::rget_y2 (query);
+  std::size_t done = 0;
+#ifdef ALGORITHM_OVERLAP_FILTER_X86
+  if constexpr (detail::simd_position<Position>::value)
+  {
+    switch (level)
+    {
+    case simd_level::avx512:
+      done = detail::overlap_masks_avx512 (rects, qx1, qx2, qy1, qy2, masks.data());
+      break;
+    case simd_level::avx2:
+      done = detail::overlap_masks_avx2 (rects, qx1, qx2, qy1, qy2, masks.data());
+      break;
+    case simd_level::sse4_2:
+      done = detail::overlap_masks_sse4_2 (rects, qx1, qx2, qy1, qy2, masks.data());
+      break;
+    case simd_level::scalar:
+      break;
+    }
+  }
+#else
+  static_cast<void>(level);
+#endif
+  detail::overlap_masks_scalar (rects, done, qx1, qx2, qy1, qy2, masks.data());
+}
+
+template <typename Position, typename A, typename Rectangle, typename MaskAllocator>
+void overlap_masks (soa_rectangles<Position, A> const& rects, Rectangle const& query
+                    , std::vector<std::uint64_t, MaskAllocator>& masks)
+{
+  algorithm::overlap_masks (rects, query, masks, detected_simd_level());
+}
+
+// Calls f (i) for every rectangle i of rects that overlaps query, in
+// index order. masks is scratch space.
+template <typename Position, typename A, typename Rectangle, typename MaskAllocator, typename F>
+void for_each_overlap (soa_rectangles<Position, A> const& rects, Rectangle const& query
+                       , std::vector<std::uint64_t, MaskAllocator>& masks, F&& f)
+{
+  algorithm::overlap_masks (rects, query, masks);
+  for (std::size_t w = 0; w != masks.size(); ++w)
+    for (auto mask = masks[w]; mask != 0; mask &= mask - 1)
+      f (w * 64 + static_cast<std::size_t>(std::countr_zero (mask)));
+}
+
+} }
+
+#endif
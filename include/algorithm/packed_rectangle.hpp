@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_PACKED_RECTANGLE_HPP
+#define ALGORITHM_PACKED_RECTANGLE_HPP
+
+#include <algorithm/interval.hpp>
+#include <algorithm/rectangle.hpp>
+#include <algorithm/split_rectangles.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+namespace exp { namespace algorithm {
+
+// Interval of 16 bit positions. The accessors are friends so they are
+// found for it wherever the interval_api ones are used.
+template <typename T>
+struct packed_interval
+{
+  static_assert (std::is_integral<T>::value && sizeof (T) == 2, "packed intervals hold 16 bit positions");
+
+  T begin;
+  T end;
+
+  friend T get_interval_begin (packed_interval i) { return i.begin; }
+  friend T get_interval_end (packed_interval i) { return i.end; }
+
+  friend bool operator==(packed_interval l, packed_interval r) { return l.begin == r.begin && l.end == r.end; }
+  friend bool operator!=(packed_interval l, packed_interval r) { return !(l == r); }
+
+  friend std::ostream& operator<<(std::ostream& os, packed_interval i)
+  {
+    return os << "[x1: " << i.begin << " x2: " << i.end << "]";
+  }
+};
+
+namespace interval_api {
+
+template <typename T>
+struct interval_position_type<packed_interval<T>>
+{
+  typedef T type;
+};
+
+}
+
+// A rectangle of 16 bit positions in 8 bytes, x1, x2, y1 and y2, half
+// of a rectangle of int pairs. Overlap tests and disposition codes work
+// on the four positions as one 64 bit word.
+template <typename T = std::uint16_t>
+using packed_rectangle = rectangle<packed_interval<T>, packed_interval<T>>;
+
+namespace detail {
+
+constexpr std::uint64_t packed_lane_high = 0x8000800080008000ull;
+constexpr std::uint64_t packed_lane_low = 0x0001000100010001ull;
+// lanes 0 and 2 or 1 and 3 of a packed word
+constexpr std::uint64_t packed_lanes_02 = 0x0000ffff0000ffffull;
+constexpr std::uint64_t packed_lanes_13 = 0xffff0000ffff0000ull;
+
+// x1 in lane 0, the low 16 bits, to y2 in lane 3. Signed positions
+// have the sign bit flipped so lanes compare as unsigned.
+template <typename T>
+std::uint64_t packed_word (packed_rectangle<T> const& r)
+{
+  std::uint64_t w = std::uint64_t (static_cast<std::uint16_t>(r.i0.begin))
+    | std::uint64_t (static_cast<std::uint16_t>(r.i0.end)) << 16
+    | std::uint64_t (static_cast<std::uint16_t>(r.i1.begin)) << 32
+    | std::uint64_t (static_cast<std::uint16_t>(r.i1.end)) << 48;
+  return std::is_signed<T>::value ? w ^ packed_lane_high : w;
+}
+
+// The high bit of each lane set when the lane of a is less than the
+// one of b. The low 15 bits are compared by subtracting them from b's
+// with the high bit set, which can not borrow from the next lane.
+inline std::uint64_t packed_lanes_less (std::uint64_t a, std::uint64_t b)
+{
+  std::uint64_t low_less = ((b | packed_lane_high) - (a & ~packed_lane_high) - packed_lane_low) & packed_lane_high;
+  return ((b & ~a) | (~(a ^ b) & low_less)) & packed_lane_high;
+}
+
+template <typename T>
+bool packed_rectangles_overlap (packed_rectangle<T> const& l, packed_rectangle<T> const& r)
+{
+  std::uint64_t lw = detail::packed_word (l), rw = detail::packed_word (r);
+  // l.x1 < r.x2, r.x1 < l.x2, l.y1 < r.y2 and r.y1 < l.y2
+  std::uint64_t begins = (lw & packed_lanes_02) | (rw & packed_lanes_02) << 16;
+  std::uint64_t ends = (rw >> 16 & packed_lanes_02) | (lw & packed_lanes_13);
+  return detail::packed_lanes_less (begins, ends) == packed_lane_high;
+}
+
+template <typename T>
+unsigned packed_split_code (packed_rectangle<T> const& dividend, packed_rectangle<T> const& divisor)
+{
+  std::uint64_t e = detail::packed_word (dividend), i = detail::packed_word (divisor);
+  // the lanes where the disposition does not hold: e.x1 < i.x1,
+  // i.x2 < e.x2, e.y1 < i.y1 and i.y2 < e.y2
+  std::uint64_t m = ~detail::packed_lanes_less ((e & packed_lanes_02) | (i & packed_lanes_13)
+                                                , (i & packed_lanes_02) | (e & packed_lanes_13));
+  return static_cast<unsigned>((m >> 31 & 1) << 3 | (m >> 63 & 1) << 2 | (m >> 15 & 1) << 1 | (m >> 47 & 1));
+}
+
+template <>
+inline bool rectangles_overlap (packed_rectangle<std::uint16_t> const& l, packed_rectangle<std::uint16_t> const& r)
+{
+  return detail::packed_rectangles_overlap (l, r);
+}
+
+template <>
+inline bool rectangles_overlap (packed_rectangle<std::int16_t> const& l, packed_rectangle<std::int16_t> const& r)
+{
+  return detail::packed_rectangles_overlap (l, r);
+}
+
+template <>
+inline unsigned split_code (packed_rectangle<std::uint16_t> const& dividend, packed_rectangle<std::uint16_t> const& divisor)
+{
+  return detail::packed_split_code (dividend, divisor);
+}
+
+template <>
+inline unsigned split_code (packed_rectangle<std::int16_t> const& dividend, packed_rectangle<std::int16_t> const& divisor)
+{
+  return detail::packed_split_code (dividend, divisor);
+}
+
+}
+
+} }
+
+#endif
@@ -0,0 +1,222 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_PACKED_RTREE_HPP
+#define ALGORITHM_PACKED_RTREE_HPP
+
+#include <algorithm/rectangle.hpp>
+#include <algorithm/split_rectangles.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include <cassert>
+
+namespace exp { namespace algorithm {
+
+namespace detail {
+
+// Distance along the Hilbert curve that fills a 2^16 by 2^16 grid
+inline std::uint32_t hilbert_index (std::uint32_t x, std::uint32_t y)
+{
+  std::uint32_t constexpr n = 1u << 16;
+  std::uint32_t d = 0;
+  for (std::uint32_t s = n / 2; s != 0; s /= 2)
+  {
+    std::uint32_t rx = (x & s) != 0, ry = (y & s) != 0;
+    d += s * s * ((3 * rx) ^ ry);
+    if (ry == 0)
+    {
+      if (rx == 1)
+      {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap (x, y);
+    }
+  }
+  return d;
+}
+
+// Sorts (key, value) pairs by key, a byte at a time
+template <typename Pair>
+void radix_sort_keys (std::vector<Pair>& pairs)
+{
+  std::vector<Pair> scratch (pairs.size());
+  for (unsigned shift = 0; shift != 32; shift += 8)
+  {
+    std::array<std::size_t, 257> offsets {};
+    for (auto&& p : pairs)
+      ++offsets[(p.first >> shift & 0xff) + 1];
+    for (std::size_t i = 1; i != offsets.size(); ++i)
+      offsets[i] += offsets[i - 1];
+    for (auto&& p : pairs)
+      scratch[offsets[p.first >> shift & 0xff]++] = p;
+    pairs.swap (scratch);
+  }
+}
+
+}
+
+// A static R-tree over disjoint rectangles, such as the fragments of
+// rectangle_partition, for point location and intersection queries.
+//
+// The rectangles are ordered along a Hilbert curve through their
+// centers and packed Fanout to a node, and the levels above are the
+// bounding boxes of Fanout nodes each, all in one array: the
+// rectangles first, then every level up to the root. The children of
+// a node are found by its index, so there are no pointers. Building is
+// linear, the keys are sorted by radix, and a query visits O(log n +
+// k) nodes when the rectangles do not overlap much.
+//
+// Queries give indices into fragments(), which keeps the rectangles in
+// Hilbert order, not in the order they were given.
+template <typename Rectangle, std::size_t Fanout = 16>
+class packed_rtree
+{
+public:
+  typedef Rectangle value_type;
+  typedef typename detail::rectangle_position<Rectangle>::type position_type;
+
+  static_assert (Fanout >= 2, "a node needs two children at least");
+
+  packed_rtree () = default;
+  template <typename Container>
+  explicit packed_rtree (Container const& rects)
+  {
+    std::size_t const n = static_cast<std::size_t>(std::distance (std::begin (rects), std::end (rects)));
+    if (n == 0)
+      return;
+    assert (n <= UINT32_MAX);
+
+    // the grid of the curve spans the bounds of the centers
+    double min_x = 0, max_x = 0, min_y = 0, max_y = 0;
+    bool first = true;
+    for (auto&& r : rects)
+    {
+      double cx = center (detail::rget_x1 (r), detail::rget_x2 (r)), cy = center (detail::rget_y1 (r), detail::rget_y2 (r));
+      min_x = first || cx < min_x ? cx : min_x;
+      max_x = first || max_x < cx ? cx : max_x;
+      min_y = first || cy < min_y ? cy : min_y;
+      max_y = first || max_y < cy ? cy : max_y;
+      first = false;
+    }
+    double const scale_x = max_x > min_x ? 65535 / (max_x - min_x) : 0
+      , scale_y = max_y > min_y ? 65535 / (max_y - min_y) : 0;
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> keys;
+    keys.reserve (n);
+    for (auto&& r : rects)
+    {
+      auto hx = static_cast<std::uint32_t>((center (detail::rget_x1 (r), detail::rget_x2 (r)) - min_x) * scale_x);
+      auto hy = static_cast<std::uint32_t>((center (detail::rget_y1 (r), detail::rget_y2 (r)) - min_y) * scale_y);
+      keys.push_back ({detail::hilbert_index (hx, hy), static_cast<std::uint32_t>(keys.size())});
+    }
+    detail::radix_sort_keys (keys);
+
+    std::size_t total = n;
+    for (std::size_t level = n; level != 1; )
+    {
+      level = (level + Fanout - 1) / Fanout;
+      total += level;
+    }
+    nodes.reserve (total);
+    std::vector<Rectangle> input (std::begin (rects), std::end (rects));
+    for (auto&& k : keys)
+      nodes.push_back (input[k.second]);
+
+    levels.push_back (0);
+    for (std::size_t begin = 0, end = n; end - begin != 1; )
+    {
+      for (std::size_t c = begin; c < end; c += Fanout)
+      {
+        Rectangle box = nodes[c];
+        for (std::size_t i = c + 1; i != std::min (c + Fanout, end); ++i)
+          box = Rectangle {{std::min (detail::rget_x1 (box), detail::rget_x1 (nodes[i]))
+                            , std::max (detail::rget_x2 (box), detail::rget_x2 (nodes[i]))}
+                           , {std::min (detail::rget_y1 (box), detail::rget_y1 (nodes[i]))
+                              , std::max (detail::rget_y2 (box), detail::rget_y2 (nodes[i]))}};
+        nodes.push_back (box);
+      }
+      levels.push_back (end);
+      begin = end;
+      end = nodes.size();
+    }
+    assert (nodes.size() == total);
+  }
+
+  std::size_t size () const { return levels.empty() ? 0 : (levels.size() == 1 ? nodes.size() : levels[1]); }
+  bool empty () const { return nodes.empty(); }
+
+  std::span<Rectangle const> fragments () const { return {nodes.data(), size()}; }
+
+  // The index of a rectangle that contains (x, y), size() if none does.
+  // Rectangles are half open, so a point on a shared edge is in the one
+  // to its right or above it.
+  std::size_t locate (position_type const& x, position_type const& y) const
+  {
+    std::size_t found = size();
+    if (!empty())
+      visit (levels.size() - 1, nodes.size() - 1
+             , [&] (Rectangle const& r) { return contains (r, x, y); }
+             , [&] (std::size_t i) { found = i; return false; });
+    return found;
+  }
+
+  // Calls f (index) for every rectangle that overlaps r with some area
+  template <typename F>
+  void for_each_intersection (Rectangle const& r, F&& f) const
+  {
+    if (!empty())
+      visit (levels.size() - 1, nodes.size() - 1
+             , [&] (Rectangle const& node) { return detail::rectangles_overlap (node, r); }
+             , [&] (std::size_t i) { f (i); return true; });
+  }
+
+private:
+  static double center (position_type const& l, position_type const& r)
+  {
+    return static_cast<double>(l) / 2 + static_cast<double>(r) / 2;
+  }
+
+  static bool contains (Rectangle const& r, position_type const& x, position_type const& y)
+  {
+    return !(x < detail::rget_x1 (r)) && x < detail::rget_x2 (r) && !(y < detail::rget_y1 (r)) && y < detail::rget_y2 (r);
+  }
+
+  // Depth first from node at level, calls hit (index) for every
+  // rectangle that matches, stops when hit returns false
+  template <typename Match, typename Hit>
+  bool visit (std::size_t level, std::size_t node, Match const& match, Hit const& hit) const
+  {
+    if (!match (nodes[node]))
+      return true;
+    if (level == 0)
+      return hit (node);
+    std::size_t const first = levels[level - 1] + (node - levels[level]) * Fanout
+      , last = std::min (first + Fanout, levels[level]);
+    for (std::size_t child = first; child != last; ++child)
+      if (!visit (level - 1, child, match, hit))
+        return false;
+    return true;
+  }
+
+  // the rectangles, then each level of boxes up to the root
+  std::vector<Rectangle> nodes;
+  // levels[l] is where level l begins in nodes, level 0 are the
+  // rectangles
+  std::vector<std::size_t> levels;
+};
+
+} }
+
+#endif
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_PARALLEL_PARTITION_HPP
+#define ALGORITHM_PARALLEL_PARTITION_HPP
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/split_rectangles.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace exp { namespace algorithm {
+
+namespace detail {
+
+// About n / 4096 bands, at most 64. Depends on the input only, never
+// on the number of threads.
+inline std::size_t default_band_count (std::size_t n)
+{
+  return std::max<std::size_t> (1, std::min<std::size_t> (64, n / 4096));
+}
+
+// Borders at quantiles of the bottom edges, so bands get about the
+// same number of rectangles. Band j is [borders[j - 1], borders[j]),
+// the first and the last band are open ended.
+template <typename Container>
+std::vector<typename rectangle_position<typename Container::value_type>::type>
+  band_borders (Container const& rects, std::size_t bands)
+{
+  std::vector<typename rectangle_position<typename Container::value_type>::type> ys, borders;
+  for (auto&& r : rects)
+    ys.push_back (detail::rget_y1 (r));
+  if (ys.empty())
+    return borders;
+  std::sort (ys.begin(), ys.end());
+  for (std::size_t i = 1; i < bands; ++i)
+  {
+    auto y = ys[i * ys.size() / bands];
+    if (y != ys.front() && (borders.empty() || borders.back() != y))
+      borders.push_back (y);
+  }
+  return borders;
+}
+
+// Joins fragments of the band below with fragments of the band above
+// that touch the border between them with the same x interval. They
+// came from the same rectangle, cut by the border. ending holds the
+// fragments in out that end at the border.
+template <typename Rectangle, typename Position>
+void stitch_band (std::vector<Rectangle>& out, std::vector<std::tuple<Position, Position, std::size_t>>& ending
+                  , std::vector<Rectangle> const& band, Position border, bool has_next, Position next_border)
+{
+  std::sort (ending.begin(), ending.end());
+  std::vector<std::tuple<Position, Position, std::size_t>> next_ending;
+  for (auto&& f : band)
+  {
+    std::size_t index = out.size();
+    auto key = std::make_tuple (detail::rget_x1 (f), detail::rget_x2 (f), std::size_t (0));
+    auto it = std::lower_bound (ending.begin(), ending.end(), key);
+    if (detail::rget_y1 (f) == border && it != ending.end()
+        && std::get<0>(*it) == std::get<0>(key) && std::get<1>(*it) == std::get<1>(key))
+    {
+      index = std::get<2>(*it);
+      out[index] = Rectangle {{detail::rget_x1 (f), detail::rget_x2 (f)}, {detail::rget_y1 (out[index]), detail::rget_y2 (f)}};
+    }
+    else
+      out.push_back (f);
+    if (has_next && detail::rget_y2 (f) == next_border)
+      next_ending.push_back (std::make_tuple (detail::rget_x1 (f), detail::rget_x2 (f), index));
+  }
+  ending.swap (next_ending);
+}
+
+}
+
+// rectangle_partition over horizontal bands on up to threads threads.
+//
+// The input is cut into bands at y coordinates picked from the input,
+// rectangles are clipped to every band they cross and each band is
+// partitioned on its own. Fragments cut by a band border are joined
+// again when their x intervals match on both sides. The output covers
+// the same area with disjoint rectangles and is the same for any
+// number of threads, but it can have more fragments than the single
+// threaded partition where a rectangle was split differently on each
+// side of a border. bands is 0 to pick it from the input size.
+template <typename Container>
+Container parallel_rectangle_partition (Container rects, std::size_t threads = std::thread::hardware_concurrency()
+                                        , std::size_t bands = 0)
+{
+  typedef typename Container::value_type rectangle;
+  typedef typename detail::rectangle_position<rectangle>::type position;
+
+  if (bands == 0)
+    bands = detail::default_band_count (rects.size());
+  auto borders = detail::band_borders (rects, bands);
+  bands = borders.size() + 1;
+
+  std::vector<std::vector<rectangle>> inputs (bands);
+  for (auto&& r : rects)
+  {
+    auto y1 = detail::rget_y1 (r), y2 = detail::rget_y2 (r);
+    if (!(detail::rget_x1 (r) < detail::rget_x2 (r) && y1 < y2))
+      continue;
+    std::size_t first = std::upper_bound (borders.begin(), borders.end(), y1) - borders.begin();
+    std::size_t last = std::lower_bound (borders.begin(), borders.end(), y2) - borders.begin();
+    for (std::size_t j = first; j <= last; ++j)
+      inputs[j].push_back (rectangle {{detail::rget_x1 (r), detail::rget_x2 (r)}
+                                      , {j == first ? y1 : borders[j - 1], j == last ? y2 : borders[j]}});
+  }
+  rects.clear();
+
+  std::vector<std::vector<rectangle>> outputs (bands);
+  std::vector<std::exception_ptr> errors (bands);
+  std::atomic<std::size_t> next (0);
+  auto worker = [&]
+  {
+    for (std::size_t band; (band = next++) < bands;)
+    {
+      try
+      {
+        outputs[band] = algorithm::rectangle_partition (std::move (inputs[band]));
+      }
+      catch (...)
+      {
+        errors[band] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  pool.reserve (std::min (threads, bands));
+  try
+  {
+    for (std::size_t t = 1; t < std::min (threads, bands); ++t)
+      pool.emplace_back (worker);
+  }
+  catch (...)
+  {
+    // the threads already running use the locals of this frame, they
+    // finish the bands with this one before the error leaves it
+    worker ();
+    for (auto&& t : pool)
+      t.join();
+    throw;
+  }
+  worker ();
+  for (auto&& t : pool)
+    t.join();
+  for (auto&& e : errors)
+    if (e)
+      std::rethrow_exception (e);
+
+  std::vector<rectangle> stitched;
+  std::vector<std::tuple<position, position, std::size_t>> ending;
+  for (std::size_t band = 0; band != bands; ++band)
+  {
+    detail::stitch_band (stitched, ending, outputs[band], band ? borders[band - 1] : position ()
+                         , band + 1 != bands, band + 1 != bands ? borders[band] : position ());
+    std::vector<rectangle> ().swap (outputs[band]);
+  }
+
+  for (auto&& r : stitched)
+    detail::insert_rectangle (rects, r);
+  return rects;
+}
+
+} }
+
+#endif
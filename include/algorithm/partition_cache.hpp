@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_PARTITION_CACHE_HPP
+#define ALGORITHM_PARTITION_CACHE_HPP
+
+#include <algorithm/rectangles_partition.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cassert>
+
+namespace exp { namespace algorithm {
+
+// 128 bit fingerprint of a set of rectangles, the same for every order
+// of the same rectangles
+struct rectangle_set_fingerprint
+{
+  std::uint64_t low = 0, high = 0;
+};
+
+inline bool operator==(rectangle_set_fingerprint const& l, rectangle_set_fingerprint const& r)
+{
+  return l.low == r.low && l.high == r.high;
+}
+
+inline bool operator!=(rectangle_set_fingerprint const& l, rectangle_set_fingerprint const& r)
+{
+  return !(l == r);
+}
+
+namespace detail {
+
+// the finalizer of MurmurHash3
+inline std::uint64_t mix64 (std::uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdull;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ull;
+  k ^= k >> 33;
+  return k;
+}
+
+template <typename Rectangle>
+std::uint64_t hash_rectangle (Rectangle const& r, std::uint64_t seed)
+{
+  std::uint64_t h = seed;
+  h = detail::mix64 (h ^ static_cast<std::uint64_t>(detail::rget_x1 (r)));
+  h = detail::mix64 (h ^ static_cast<std::uint64_t>(detail::rget_x2 (r)));
+  h = detail::mix64 (h ^ static_cast<std::uint64_t>(detail::rget_y1 (r)));
+  h = detail::mix64 (h ^ static_cast<std::uint64_t>(detail::rget_y2 (r)));
+  return h;
+}
+
+struct fingerprint_hash
+{
+  std::size_t operator()(rectangle_set_fingerprint const& f) const { return static_cast<std::size_t>(f.low); }
+};
+
+}
+
+// The sums of two independent hashes of each rectangle. Sums do not
+// depend on the order, so the rectangles need not be sorted to be
+// hashed as a set, and unlike xor they tell duplicates apart.
+template <typename Container>
+rectangle_set_fingerprint fingerprint_rectangles (Container const& rects)
+{
+  static_assert (std::is_integral<typename detail::rectangle_position<typename Container::value_type>::type>::value
+                 , "only integral coordinates are fingerprinted");
+  std::uint64_t low = 0, high = 0, count = 0;
+  for (auto&& r : rects)
+  {
+    low += detail::hash_rectangle (r, 0x9e3779b97f4a7c15ull);
+    high += detail::hash_rectangle (r, 0xd6e8feb86659fd93ull);
+    ++count;
+  }
+  return {detail::mix64 (low ^ count), detail::mix64 (high + count)};
+}
+
+// Memoizes rectangle_partition for callers that partition the same
+// rectangles again and again, e.g. the damage of frames that do not
+// change. A hit costs a fingerprint of the input, a miss the partition
+// of the input sorted, so the fragments only depend on the set and a
+// hit returns what a miss would. Holds the fragments of the capacity
+// sets used last. Sets with the same fingerprint are taken to be the
+// same, which only an adversary is expected to break.
+template <typename Rectangle>
+class partition_cache
+{
+public:
+  typedef std::vector<Rectangle> fragments_type;
+
+  explicit partition_cache (std::size_t capacity)
+    : capacity_ (capacity)
+  {
+    assert (capacity != 0);
+  }
+  partition_cache (partition_cache const&) = delete;
+  partition_cache& operator= (partition_cache const&) = delete;
+
+  // The fragments of rects, valid until the next call
+  template <typename Container>
+  fragments_type const& partition (Container const& rects)
+  {
+    auto fingerprint = algorithm::fingerprint_rectangles (rects);
+    auto it = index.find (fingerprint);
+    if (it != index.end())
+    {
+      ++hits_;
+      entries.splice (entries.begin(), entries, it->second);
+      return it->second->second;
+    }
+
+    ++misses_;
+    // partitioned aside first, so an exception leaves the cache as it was
+    sorted.assign (rects.begin(), rects.end());
+    std::sort (sorted.begin(), sorted.end()
+               , [] (Rectangle const& l, Rectangle const& r)
+                 {
+                   using detail::rget_x1; using detail::rget_x2; using detail::rget_y1; using detail::rget_y2;
+                   return rget_x1 (l) != rget_x1 (r) ? rget_x1 (l) < rget_x1 (r)
+                     : rget_x2 (l) != rget_x2 (r) ? rget_x2 (l) < rget_x2 (r)
+                     : rget_y1 (l) != rget_y1 (r) ? rget_y1 (l) < rget_y1 (r)
+                     : rget_y2 (l) < rget_y2 (r);
+                 });
+    algorithm::rectangle_partition (workspace, sorted, computed);
+
+    // the entry is indexed before anything else changes, the rest does
+    // not throw
+    bool evict = entries.size() == capacity_;
+    if (!evict)
+      entries.emplace_back ();
+    auto slot = std::prev (entries.end());
+    try
+    {
+      index.emplace (fingerprint, slot);
+    }
+    catch (...)
+    {
+      if (!evict)
+        entries.pop_back ();
+      throw;
+    }
+    if (evict)
+      index.erase (slot->first);
+    slot->first = fingerprint;
+    // the evicted entry's fragments keep their capacity for the next miss
+    slot->second.swap (computed);
+    entries.splice (entries.begin(), entries, slot);
+    return slot->second;
+  }
+
+  // counted over the lifetime of the cache, clear does not reset them
+  std::size_t hits () const { return hits_; }
+  std::size_t misses () const { return misses_; }
+  std::size_t size () const { return entries.size(); }
+  std::size_t capacity () const { return capacity_; }
+
+  void clear ()
+  {
+    entries.clear();
+    index.clear();
+  }
+
+private:
+  typedef std::list<std::pair<rectangle_set_fingerprint, fragments_type>> entry_list;
+
+  std::size_t capacity_;
+  std::size_t hits_ = 0, misses_ = 0;
+  // most recently used first
+  entry_list entries;
+  std::unordered_map<rectangle_set_fingerprint, typename entry_list::iterator, detail::fingerprint_hash> index;
+  std::vector<Rectangle> sorted;
+  fragments_type computed;
+  partition_workspace<Rectangle> workspace;
+};
+
+// rectangle_partition through cache, see partition_cache::partition.
+// rects is a forwarding reference so this is a better match than
+// rectangle_partition (Container, Trace&&).
+template <typename Rectangle, typename Container>
+std::vector<Rectangle> const& rectangle_partition (partition_cache<Rectangle>& cache, Container&& rects)
+{
+  return cache.partition (rects);
+}
+
+} }
+
+#endif
@@ -0,0 +1,361 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_RECTANGLE_FORMAT_HPP
+#define ALGORITHM_RECTANGLE_FORMAT_HPP
+
+#include <algorithm/interval.hpp>
+#include <algorithm/rectangle.hpp>
+#include <algorithm/split_rectangles.hpp>
+#include <algorithm/file_io.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Binary format of a set of rectangles with integral coordinates,
+// version 1. A 24 byte header:
+//
+//    0  "RSET"
+//    4  version, 1
+//    5  the coordinate type, its size in bytes | 0x80 when signed
+//    6  two zero bytes
+//    8  number of rectangles, 64 bit little endian
+//   16  size of what follows in bytes, 64 bit little endian
+//
+// then the rectangles sorted by x1, y1, x2 and y2, each as four LEB128
+// varints of zigzag encoded differences: x1 from the x1 before it, y1
+// from the y1 before it, 0 before the first, x2 from x1 and y2 from y1.
+// Differences are taken modulo 2^64, so every coordinate of up to 64
+// bits round trips. Sets can follow each other in a stream.
+//
+// The order of the rectangles is not kept, which is no loss for a set
+// of rectangles to partition or for the fragments of a partition.
+
+namespace exp { namespace algorithm {
+
+class format_error : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+
+constexpr std::size_t format_header_size = 24;
+constexpr unsigned char format_version = 1;
+
+template <typename Position>
+constexpr unsigned char format_coordinate_type ()
+{
+  return static_cast<unsigned char>(sizeof (Position) | (std::is_signed<Position>::value ? 0x80 : 0));
+}
+
+inline void put_u64 (unsigned char* p, std::uint64_t v)
+{
+  for (int i = 0; i != 8; ++i)
+    p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+inline std::uint64_t get_u64 (unsigned char const* p)
+{
+  std::uint64_t v = 0;
+  for (int i = 0; i != 8; ++i)
+    v |= std::uint64_t (p[i]) << (8 * i);
+  return v;
+}
+
+template <typename Position>
+std::uint64_t zigzag_difference (Position from, Position to)
+{
+  std::uint64_t d = static_cast<std::uint64_t>(to) - static_cast<std::uint64_t>(from);
+  return (d << 1) ^ (0 - (d >> 63));
+}
+
+template <typename Position>
+Position zigzag_add (Position from, std::uint64_t z)
+{
+  std::uint64_t d = (z >> 1) ^ (0 - (z & 1));
+  return static_cast<Position>(static_cast<std::uint64_t>(from) + d);
+}
+
+inline void put_varint (std::vector<unsigned char>& bytes, std::uint64_t v)
+{
+  while (v >= 0x80)
+  {
+    bytes.push_back (static_cast<unsigned char>(v | 0x80));
+    v >>= 7;
+  }
+  bytes.push_back (static_cast<unsigned char>(v));
+}
+
+inline std::uint64_t get_varint (unsigned char const*& p, unsigned char const* end)
+{
+  std::uint64_t v = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7)
+  {
+    if (p == end)
+      throw format_error ("rectangle set truncated");
+    unsigned char b = *p++;
+    v |= std::uint64_t (b & 0x7f) << shift;
+    if (!(b & 0x80))
+      return v;
+  }
+  throw format_error ("varint longer than 64 bits");
+}
+
+struct format_header
+{
+  std::uint64_t count;
+  std::uint64_t payload;
+};
+
+template <typename Position>
+format_header read_format_header (unsigned char const* p)
+{
+  if (!std::equal (p, p + 4, "RSET"))
+    throw format_error ("not a rectangle set");
+  if (p[4] != format_version)
+    throw format_error ("unknown rectangle set version");
+  if (p[5] != format_coordinate_type<Position>())
+    throw format_error ("rectangle set of another coordinate type");
+  format_header header {get_u64 (p + 8), get_u64 (p + 16)};
+  // every rectangle takes at least a byte per coordinate
+  if (header.payload / 4 < header.count)
+    throw format_error ("rectangle set count larger than its payload");
+  return header;
+}
+
+template <typename Container, typename Enable = std::void_t<>>
+struct has_reserve : std::false_type {};
+
+template <typename Container>
+struct has_reserve<Container, std::void_t<decltype (std::declval<Container&>().reserve (std::size_t()))>>
+  : std::true_type {};
+
+}
+
+// Appends the encoding of rects to bytes
+template <typename Container>
+void encode_rectangles (Container const& rects, std::vector<unsigned char>& bytes)
+{
+  typedef typename Container::value_type rectangle_type;
+  typedef typename detail::rectangle_position<rectangle_type>::type position;
+  static_assert (std::is_integral<position>::value && sizeof (position) <= 8
+                 , "only integral coordinates of up to 64 bits are encoded");
+
+  std::vector<rectangle_type> sorted (rects.begin(), rects.end());
+  std::sort (sorted.begin(), sorted.end()
+             , [] (rectangle_type const& l, rectangle_type const& r)
+               {
+                 using detail::rget_x1; using detail::rget_y1; using detail::rget_x2; using detail::rget_y2;
+                 return rget_x1 (l) != rget_x1 (r) ? rget_x1 (l) < rget_x1 (r)
+                   : rget_y1 (l) != rget_y1 (r) ? rget_y1 (l) < rget_y1 (r)
+                   : rget_x2 (l) != rget_x2 (r) ? rget_x2 (l) < rget_x2 (r)
+                   : rget_y2 (l) < rget_y2 (r);
+               });
+
+  std::size_t const header = bytes.size();
+  bytes.resize (header + detail::format_header_size);
+  position x = 0, y = 0;
+  for (auto&& r : sorted)
+  {
+    detail::put_varint (bytes, detail::zigzag_difference (x, detail::rget_x1 (r)));
+    detail::put_varint (bytes, detail::zigzag_difference (y, detail::rget_y1 (r)));
+    detail::put_varint (bytes, detail::zigzag_difference (detail::rget_x1 (r), detail::rget_x2 (r)));
+    detail::put_varint (bytes, detail::zigzag_difference (detail::rget_y1 (r), detail::rget_y2 (r)));
+    x = detail::rget_x1 (r);
+    y = detail::rget_y1 (r);
+  }
+  auto p = bytes.data() + header;
+  std::copy_n ("RSET", 4, p);
+  p[4] = detail::format_version;
+  p[5] = detail::format_coordinate_type<position>();
+  p[6] = p[7] = 0;
+  detail::put_u64 (p + 8, sorted.size());
+  detail::put_u64 (p + 16, bytes.size() - header - detail::format_header_size);
+}
+
+// The rectangles of an encoded set in memory, decoded as they are
+// iterated. The header is checked on construction, the rest as it is
+// read, and both throw format_error.
+template <typename Rectangle>
+class rectangle_set_view
+{
+public:
+  typedef Rectangle value_type;
+  typedef std::size_t size_type;
+  typedef typename detail::rectangle_position<Rectangle>::type position;
+
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Rectangle value_type;
+    typedef Rectangle const& reference;
+    typedef Rectangle const* pointer;
+    typedef std::ptrdiff_t difference_type;
+
+    const_iterator () = default;
+
+    reference operator*() const { return current; }
+    pointer operator->() const { return &current; }
+
+    const_iterator& operator++()
+    {
+      if (--left == 0)
+      {
+        if (p != last)
+          throw format_error ("rectangle set longer than its count");
+      }
+      else
+        decode (detail::rget_x1 (current), detail::rget_y1 (current));
+      return *this;
+    }
+    const_iterator operator++(int)
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const_iterator const& other) const { return left == other.left; }
+    bool operator!=(const_iterator const& other) const { return !(*this == other); }
+
+  private:
+    friend class rectangle_set_view;
+    const_iterator (unsigned char const* p, unsigned char const* last, size_type left)
+      : p (p), last (last), left (left)
+    {
+      if (left != 0)
+        decode (0, 0);
+      else if (p != last)
+        throw format_error ("rectangle set longer than its count");
+    }
+
+    void decode (position x, position y)
+    {
+      auto x1 = detail::zigzag_add (x, detail::get_varint (p, last));
+      auto y1 = detail::zigzag_add (y, detail::get_varint (p, last));
+      auto x2 = detail::zigzag_add (x1, detail::get_varint (p, last));
+      auto y2 = detail::zigzag_add (y1, detail::get_varint (p, last));
+      current = Rectangle {{x1, x2}, {y1, y2}};
+    }
+
+    unsigned char const* p = nullptr;
+    unsigned char const* last = nullptr;
+    size_type left = 0;
+    Rectangle current {};
+  };
+  typedef const_iterator iterator;
+
+  static_assert (std::is_integral<position>::value && sizeof (position) <= 8
+                 , "only integral coordinates of up to 64 bits are encoded");
+
+  rectangle_set_view (void const* data, std::size_t size)
+    : first (static_cast<unsigned char const*>(data))
+  {
+    if (size < detail::format_header_size)
+      throw format_error ("rectangle set truncated");
+    auto header = detail::read_format_header<position> (first);
+    if (header.payload != size - detail::format_header_size)
+      throw format_error ("rectangle set size does not match its header");
+    count = static_cast<size_type>(header.count);
+    first += detail::format_header_size;
+    last = first + header.payload;
+  }
+
+  size_type size () const { return count; }
+  bool empty () const { return count == 0; }
+  const_iterator begin () const { return {first, last, count}; }
+  const_iterator end () const { return {}; }
+
+private:
+  unsigned char const* first;
+  unsigned char const* last;
+  size_type count;
+};
+
+// rectangle_set_view of a file, which is mapped instead of read
+template <typename Rectangle>
+class mapped_rectangle_set
+{
+public:
+  typedef Rectangle value_type;
+  typedef std::size_t size_type;
+  typedef typename rectangle_set_view<Rectangle>::const_iterator const_iterator;
+  typedef const_iterator iterator;
+
+  explicit mapped_rectangle_set (char const* path)
+    : file (path), view (file.data(), file.size()) {}
+
+  size_type size () const { return view.size(); }
+  bool empty () const { return view.empty(); }
+  const_iterator begin () const { return view.begin(); }
+  const_iterator end () const { return view.end(); }
+
+private:
+  detail::mapped_file file;
+  rectangle_set_view<Rectangle> view;
+};
+
+// Replaces the contents of out, any container rectangle_partition
+// takes, with the encoded rectangles in [data, data + size)
+template <typename Container>
+void decode_rectangles (void const* data, std::size_t size, Container& out)
+{
+  rectangle_set_view<typename Container::value_type> view (data, size);
+  out.clear();
+  if constexpr (detail::has_reserve<Container>::value)
+    out.reserve (view.size());
+  for (auto&& r : view)
+    out.insert (out.end(), r);
+}
+
+template <typename Container>
+std::ostream& write_rectangles (std::ostream& os, Container const& rects)
+{
+  std::vector<unsigned char> bytes;
+  algorithm::encode_rectangles (rects, bytes);
+  return os.write (reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Reads one set written by write_rectangles, leaving the stream after
+// it. A set that is cut short or malformed throws format_error.
+template <typename Container>
+std::istream& read_rectangles (std::istream& is, Container& out)
+{
+  typedef typename detail::rectangle_position<typename Container::value_type>::type position;
+  std::vector<unsigned char> bytes (detail::format_header_size);
+  if (!is.read (reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())))
+    throw format_error ("rectangle set truncated");
+  auto header = detail::read_format_header<position> (bytes.data());
+  // grows as the payload arrives, a corrupt size runs out of stream
+  // before it runs out of memory
+  std::size_t const step = std::size_t (1) << 20;
+  for (std::uint64_t left = header.payload; left != 0;)
+  {
+    std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t> (left, step));
+    bytes.resize (bytes.size() + n);
+    if (!is.read (reinterpret_cast<char*>(bytes.data() + bytes.size() - n), static_cast<std::streamsize>(n)))
+      throw format_error ("rectangle set truncated");
+    left -= n;
+  }
+  algorithm::decode_rectangles (bytes.data(), bytes.size(), out);
+  return is;
+}
+
+} }
+
+#endif
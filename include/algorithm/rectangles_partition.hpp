@@ -13,106 +13,35 @@
 #include <algorithm/split_rectangles.hpp>
 #include <algorithm/event.hpp>
 #include <algorithm/event_scan.hpp>
-
+#include <algorithm/sweep_trace.hpp>
+#include <algorithm/btree_multiset.hpp>
+#include <algorithm/event_builder.hpp>
+#include <algorithm/overlap_filter.hpp>
+#include <algorithm/split_batch.hpp>
+
+#include <bit>
+#include <cstdint>
 #include <set>
+#include <vector>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <compare>
 
 namespace exp { namespace algorithm {
 
 namespace detail {
 
-template <typename Event0, typename Open0, typename Open1, typename Overlapped, typename Rectangle>
-void erase_rectangle (std::multiset<Event0>& set, Open0& open0, Open1& open1, Overlapped& overlapped_at_0, Rectangle r)
-{
-  // std::cout << "erasing " << r << std::endl;
-  using algorithm::event_type;
-  auto range = set.equal_range ({event_type::begin, {r}});
-  while (range.first != range.second && range.first->interval.rectangle != r)
-    ++range.first;
-  assert (range.first != range.second);
-  assert (range.first->interval.rectangle == r);
-  auto s = set.size();
-  //std::cout << "erasing (begin) from set " << *range.first << " (searched for " << r << ")" << std::endl;
-  set.erase (range.first);
-  assert (set.size() + 1 == s);
-
-  range = set.equal_range ({event_type::end, {r}});
-  while (range.first != range.second && range.first->interval.rectangle != r)
-    ++range.first;
-  assert (range.first != range.second);
-  assert (range.first->interval.rectangle == r);
-  s = set.size();
-  //std::cout << "erasing (end) from set " << *range.first << " (searched for " << r << ")" << std::endl;
-  set.erase (range.first);
-  assert (set.size() + 1 == s);
-
-  {
-    typename Open0::value_type event0 {event_type::begin, r};
-    // std::cout << "searching dim-0 " << event0 << std::endl;
-    assert (std::find (open0.begin(), open0.end(), event0) != open0.end());
-    auto it = std::lower_bound (open0.begin(), open0.end(), event0);
-    assert (it != open0.end());
-    while (it != open0.end() && it->interval.rectangle != r)
-      ++it;
-    assert (it != open0.end());
-    // std::cout << "it: " << *it << " searching " << event0 << " old size open0 " << open0.size() << std::endl;
-    assert (*it == event0);
-    open0.erase (it);
-    // std::cout << " open0 new size " << open0.size() << std::endl;
-  }
-
-  {
-    typename Overlapped::value_type event1 {event_type::begin, r};
-    assert (std::find (overlapped_at_0.begin(), overlapped_at_0.end(), event1) != overlapped_at_0.end());
-    auto it = std::lower_bound (overlapped_at_0.begin(), overlapped_at_0.end(), event1);
-    assert (it != overlapped_at_0.end());
-    while (it != overlapped_at_0.end() && it->interval.rectangle != r)
-      ++it;
-    assert (it != overlapped_at_0.end());
-    // std::cout << "overlap open it: " << *it << " searching " << event1 << " old size overlap " << overlapped_at_0.size() << std::endl;
-    assert (*it == event1);
-    overlapped_at_0.erase (it);
-    // std::cout << " overlap new size " << open0.size() << std::endl;
-
-    using event_api::get_opposite_event;
-    auto op_event1 = get_opposite_event(event1);
-    auto end_it = std::lower_bound (overlapped_at_0.begin(), overlapped_at_0.end(), op_event1);
-    assert (end_it != overlapped_at_0.end());
-    while (end_it != overlapped_at_0.end() && end_it->interval.rectangle != r)
-      ++end_it;
-    assert (end_it != overlapped_at_0.end());
-    // std::cout << "overlap close it: " << *end_it << " searching " << op_event1 << " old size overlap " << overlapped_at_0.size() << std::endl;
-    assert (*end_it == op_event1);
-    overlapped_at_0.erase (end_it);
-    // std::cout << " overlap new size " << open0.size() << std::endl;
-  }
-
-  {
-    typename Open1::value_type event1 {event_type::begin, r};
-    // std::cout << "searching dim-1 " << event1 << std::endl;
-    assert (std::find (open1.begin(), open1.end(), event1) != open1.end());
-    auto it = std::lower_bound (open1.begin(), open1.end(), event1);
-    assert (it != open1.end());
-    while (it != open1.end() && it->interval.rectangle != r)
-      ++it;
-    assert (*it == event1);
-    // std::cout << "it: " << *it << " searching " << event1 << " open1 old size " << open1.size() << std::endl;
-    assert (*it == event1);
-    open1.erase (it);
-    // std::cout << " open1 new size " << open1.size() << std::endl;
-
-    // std::cout << "new (after erase) open_1:" << std::endl;
-    // for (auto& no1 : open1)
-    //   std::cout << "     elem: " << no1 << std::endl;
-  }
-}
-  
 template <typename Rectangle, std::size_t N>
 struct interval_n
 {
   typedef std::integral_constant<std::size_t, N> dim;
   typedef Rectangle rectangle_type;
   Rectangle rectangle;
+  // where a sweep keeps the rectangle while it is open, carried by its
+  // end event and not part of the order or of equality
+  std::uint32_t handle = 0;
   std::weak_ordering operator<=> (interval_n<Rectangle, N> const& other) const
   {
     return rectangle.i0 < other.rectangle.i0
@@ -177,274 +106,404 @@ get_interval_end (interval_n<Rectangle, 0> const& i0)
 }
 
 template <typename Rectangle>
-typename algorithm::interval_api::interval_position_type<typename Rectangle::i0_type>::type
+typename algorithm::interval_api::interval_position_type<typename Rectangle::i1_type>::type
 get_interval_end (interval_n<Rectangle, 1> const& i1)
 {
   using algorithm::interval_api::get_interval_end;
   return get_interval_end (i1.rectangle.i1);
 }
 
-template <typename Event1, typename Event0>
-algorithm::sweep_interrupt handle_close_1 (std::vector<Event1>& open_1, Event1 last_close_1
-                                           , std::vector<Event0>& open_0, Event0 first_close_0
-                                           , std::multiset<Event0>& set, std::multiset<Event1>& overlapped_at_0)
+// The rectangles open in dim-0 sorted by their begin events, with
+// their coordinates mirrored in a soa_rectangles for the overlap
+// filter of split_against_open, and its scratch space, all allocated
+// with Allocator.
+//
+// insert returns a handle that stays valid until the rectangle is
+// erased, so erase does not search. An erased rectangle leaves its
+// slot behind with coordinates no query overlaps, and the slots are
+// compacted, in order, once most of them are erased.
+template <typename Event0, typename Allocator = std::allocator<Event0>>
+struct open_set
 {
-  using algorithm::interval_api::get_interval_end;
-  using algorithm::interval_api::get_interval_begin;
-
-  //std::cout << "last_close_1 " << last_close_1 << " open_1.size() " << open_1.size() << " open0.size() " << open_0.size() << std::endl;
-  
-  //auto current_1 = open_1.begin ();
-  std::size_t current_index_1 = 0;
-
-  auto current_1 = [&] { return open_1[current_index_1]; };
-
-  // std::cout << "open_0(" << open_0.size() << "): " << std::endl;
-  // for (auto& o0 : open_0)
-  //   std::cout << "     elem: " << o0 << std::endl;
-  // std::cout << "open_1:" << std::endl;
-  // for (auto& o1 : open_1)
-  //   std::cout << "     elem: " << o1 << std::endl;
-  //Event0 const last_close_0 {last_close_1.type, {last_close_1.interval.rectangle}};
-
-  // We have all open in dim-0 and in dim-1 and we're checking close_0 and last_close_1
-  // which are not necessarily the same
-  // The open in dim-1 is a subset of the open in dim-0
-  // As a consequence, in open_1 they overlap with last_close_1.
-
-  auto get_x1 = [] (auto&& e) { return detail::rget_x1(e.interval.rectangle); };
-  auto get_x2 = [] (auto&& e) { return detail::rget_x2(e.interval.rectangle); };
-  auto get_y1 = [] (auto&& e) { return detail::rget_y1(e.interval.rectangle); };
-  auto get_y2 = [] (auto&& e) { return detail::rget_y2(e.interval.rectangle); };
-  // The algorithm is: go through each element in open_1
-  // for each one, see if it really overlaps and it is not the same as close_1
-  // Then run rectangle splitting
-  while (current_index_1 != open_1.size())
+  typedef typename Event0::interval_type::rectangle_type rectangle_type;
+  typedef typename rectangle_position<rectangle_type>::type position_type;
+  typedef typename simd_mirror_position<position_type>::type mirror_type;
+  typedef std::uint32_t handle_type;
+  template <typename T>
+  using rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+  typedef soa_rectangles<mirror_type, rebind<mirror_type>> soa_type;
+
+  static constexpr handle_type no_handle = ~handle_type (0);
+
+  open_set () = default;
+  explicit open_set (Allocator const& allocator)
+    : events (allocator), coordinates (allocator), handles (allocator), slots (allocator)
+    , free_handles (allocator), masks (allocator), pieces (allocator), scratch (allocator), codes (allocator) {}
+
+  std::vector<Event0, rebind<Event0>> events;
+  soa_type coordinates;
+  // handles[i] is the handle of events[i], no_handle once it is erased
+  std::vector<handle_type, rebind<handle_type>> handles;
+  // slots[h] is the index in events of handle h
+  std::vector<handle_type, rebind<handle_type>> slots;
+  std::vector<handle_type, rebind<handle_type>> free_handles;
+  std::size_t live = 0;
+  std::vector<std::uint64_t, rebind<std::uint64_t>> masks;
+  soa_type pieces, scratch;
+  std::vector<unsigned char, rebind<unsigned char>> codes;
+
+  bool empty () const { return live == 0; }
+  std::size_t size () const { return live; }
+
+  void clear ()
   {
-  while (current_index_1 != open_1.size()
-         && (current_1().interval.rectangle == last_close_1.interval.rectangle
-             || get_x2(current_1()) <= get_x1(last_close_1) // current_1 comes before last_close_1 begin dim-0
-             || get_y2(current_1()) <= get_y1(last_close_1) // current_1 comes before last_close_1 begin dim-1
-             || get_x2(last_close_1) <= get_x1(current_1()) // last_close_1 comes before current_1 begin dim-0
-             || get_y2(last_close_1) <= get_y1(current_1()) // last_close_1 comes before current_1 begin dim-1
-            ))
+    events.clear();
+    coordinates.clear();
+    handles.clear();
+    slots.clear();
+    free_handles.clear();
+    live = 0;
+  }
+
+  handle_type insert (Event0 const& e)
   {
-    ++current_index_1;
+    auto const slot = static_cast<std::size_t>(std::lower_bound (events.begin(), events.end(), e) - events.begin());
+    coordinates.insert (slot, e.interval.rectangle);
+    events.insert (events.begin() + slot, e);
+    handle_type h;
+    if (free_handles.empty())
+    {
+      assert (slots.size() < no_handle);
+      h = static_cast<handle_type>(slots.size());
+      slots.push_back (0);
+    }
+    else
+    {
+      h = free_handles.back();
+      free_handles.pop_back();
+    }
+    handles.insert (handles.begin() + slot, h);
+    // the sweep opens rectangles at its position, the ones after slot
+    // are only those that begin there too
+    for (std::size_t i = slot; i != handles.size(); ++i)
+      if (handles[i] != no_handle)
+        slots[handles[i]] = static_cast<handle_type>(i);
+    ++live;
+    return h;
   }
 
-  if (current_index_1 == open_1.size ())
+  void erase (handle_type h)
   {
-    return sweep_interrupt::continue_;
+    auto const slot = slots[h];
+    assert (handles[slot] == h);
+    handles[slot] = no_handle;
+    coordinates.x1()[slot] = std::numeric_limits<mirror_type>::max();
+    coordinates.x2()[slot] = std::numeric_limits<mirror_type>::lowest();
+    free_handles.push_back (h);
+    if (2 * --live < events.size())
+      compact ();
   }
 
-  assert (std::find_if (open_1.begin(), open_1.end()
-                        , [&] (Event1 const& e1)
-                          { return e1.interval.rectangle == last_close_1.interval.rectangle; }) != open_1.end());
+private:
+  void compact ()
+  {
+    auto x1 = coordinates.x1(), x2 = coordinates.x2(), y1 = coordinates.y1(), y2 = coordinates.y2();
+    std::size_t out = 0;
+    for (std::size_t i = 0; i != events.size(); ++i)
+    {
+      if (handles[i] == no_handle)
+        continue;
+      events[out] = events[i];
+      x1[out] = x1[i];
+      x2[out] = x2[i];
+      y1[out] = y1[i];
+      y2[out] = y2[i];
+      handles[out] = handles[i];
+      slots[handles[out]] = static_cast<handle_type>(out);
+      ++out;
+    }
+    events.resize (out);
+    coordinates.resize (out);
+    handles.resize (out);
+  }
+};
 
-  auto divisor = last_close_1.interval.rectangle
-    , dividend = current_1().interval.rectangle;
+template <typename Event0, typename Allocator, typename Trace = null_trace>
+void erase_rectangle (open_set<Event0, Allocator>& open_0, typename open_set<Event0, Allocator>::handle_type h
+                      , Trace&& trace = Trace{})
+{
+  auto r = open_0.events[open_0.slots[h]].interval.rectangle;
+  open_0.erase (h);
+  trace (trace_point::erase, r);
+}
 
-  std::cout << "dividend " << dividend << " divisor " << divisor << std::endl;
+template <typename Container, typename Rectangle>
+void insert_rectangle (Container& c, Rectangle const& r
+                       , typename std::enable_if<has_key_compare<Container>::value>::type* = nullptr)
+{
+  c.insert (r);
+}
 
-  using algorithm::interval_api::get_interval_begin;
-  using algorithm::interval_api::get_interval_end;
-  // divisor ends after dividend in dim-0
+template <typename Container, typename Rectangle>
+void insert_rectangle (Container& c, Rectangle const& r
+                       , typename std::enable_if<!has_key_compare<Container>::value>::type* = nullptr)
+{
+  c.push_back (r);
+}
 
-  bool closes_after_0 = rget_x2 (divisor) >= rget_x2 (dividend);
-  bool opens_before_0 = rget_x1 (divisor) <= rget_x1 (dividend);
-  bool opens_before_1 = rget_y1 (divisor) <= rget_y1 (dividend);
-  bool closes_after_1 = rget_y2 (divisor) >= rget_y2 (dividend);
-  
-  std::vector<decltype(dividend)> split_rectangles;
-  switch (static_cast<int>(closes_after_0) << 3 | static_cast<int>(closes_after_1) << 2 | static_cast<int>(opens_before_0) << 1 | static_cast<int>(opens_before_1))
-  {
-  case 0b0000:
-    //std::cout << "0b0000:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_middle_t{}, algorithm::overlap_disposition_middle_t{});
-    break;
-  case 0b0001:
-    //std::cout << "0b0001:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_middle_t{}, algorithm::overlap_disposition_before_t{});
-    break;
-  case 0b0010:
-    //std::cout << "0b0010:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_before_t{}, algorithm::overlap_disposition_middle_t{});
-    break;
-  case 0b0011:
-    //std::cout << "0b0011:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_before_t{}, algorithm::overlap_disposition_before_t{});
-    break;
-  case 0b0100:
-    //std::cout << "0b0100:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_middle_t{}, algorithm::overlap_disposition_after_t{});
-    break;
-  case 0b0101:
-    //std::cout << "0b0101:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_middle_t{}, algorithm::overlap_disposition_across_t{});
-    break;
-  case 0b0110:
-    //std::cout << "0b0110:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_before_t{}, algorithm::overlap_disposition_after_t{});
-    break;
-  case 0b0111:
-    //std::cout << "0b0111:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_before_t{}, algorithm::overlap_disposition_across_t{});
-    break;
-  case 0b1000:
-    //std::cout << "0b1000:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_after_t{}, algorithm::overlap_disposition_middle_t{});
-    break;
-  case 0b1001:
-    //std::cout << "0b1001:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_after_t{}, algorithm::overlap_disposition_before_t{});
-    break;
-  case 0b1010:
-    //std::cout << "0b1010:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_across_t{}, algorithm::overlap_disposition_middle_t{});
-    break;
-  case 0b1011:
-    //std::cout << "0b1011:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_across_t{}, algorithm::overlap_disposition_before_t{});
-    break;
-  case 0b1100:
-    //std::cout << "0b1100:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_after_t{}, algorithm::overlap_disposition_after_t{});
-    break;
-  case 0b1101:
-    //std::cout << "0b1101:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_after_t{}, algorithm::overlap_disposition_across_t{});
-    break;
-  case 0b1110:
-    //std::cout << "0b1110:" << std::endl;
-    split_rectangles = algorithm::split_rectangle (dividend, divisor, algorithm::overlap_disposition_across_t{}, algorithm::overlap_disposition_after_t{});
-    break;
-  case 0b1111:
-    //std::cout << "0b1111:" << std::endl;
-    // completely covers rectangle, just remove it
-    break;
-  }
-  if (dividend != first_close_0.interval.rectangle)
-    detail::erase_rectangle (set, open_0, open_1, overlapped_at_0, dividend);
-  else
-    ++current_index_1;
-  
-  for (auto&& r : split_rectangles)
+// Splits every piece that overlaps divisor, returns true when nothing
+// is left of them
+template <typename Rectangle, typename Allocator, typename Trace>
+bool split_pieces (Rectangle const& divisor, std::vector<Rectangle, Allocator>& pieces
+                   , std::vector<Rectangle, Allocator>& scratch, Trace&& trace)
+{
+  scratch.clear();
+  for (auto&& piece : pieces)
   {
-    //std::cout << "split rectangle " << r << std::endl;
-    using exp::algorithm::event_api::get_opposite_event;
-    Event0 e0 {event_type::begin, r};
-    Event1 e1 {event_type::begin, r};
-    auto op_e0 = get_opposite_event (e0);
-    auto it = std::lower_bound (set.begin(), set.end(), e0);
-    if (it == set.end() || *it != e0)
+    if (detail::rectangles_overlap (piece, divisor))
     {
-      std::cout << "  insert e0 " << e0 << " and opposite e0 " << get_opposite_event (e0) << std::endl;
-      set.insert (it, e0);
-      set.insert (op_e0);
-
-      std::less<Event0> const e0_compare;
-      //std::cout << "comparing e0: " << e0 << " with first_close_0: " << first_close_0 << std::endl;
-      if (e0_compare(e0, first_close_0) // must begin before end
-          && e0_compare(first_close_0, op_e0)) // and must not have closed yet
-      {
-        //std::cout << "  adding open0 " << e0 << " while compared to " << first_close_0 << std::endl;
-        auto it = std::lower_bound (open_0.begin(), open_0.end(), e0, e0_compare);
-        open_0.insert (it, e0);
-
-        // lets add to overlapped_at_0 only if we add to open_0
-        auto op_e1 = get_opposite_event (e1);
-        overlapped_at_0.insert (e1);
-        overlapped_at_0.insert (op_e1);
-
-        std::less<Event1> const e1_compare;
-        //std::cout << "comparing e1: " << e1 << " with last_close_1: " << last_close_1 << std::endl;
-        if (e1_compare(e1, last_close_1) // must begin before end
-            && e1_compare(last_close_1, op_e1)) // and must not have closed yet
-        {
-          //std::cout << "  adding open1 " << e1 << " while compared to " << last_close_1 << std::endl;
-          auto it = std::lower_bound (open_1.begin(), open_1.end(), e1, e1_compare);
-          open_1.insert (it, e1);
-        }
-      }
+      trace (trace_point::split, piece, divisor);
+      algorithm::split_rectangle (piece, divisor, std::back_inserter (scratch));
     }
+    else
+      scratch.push_back (piece);
   }
+  pieces.swap (scratch);
+  return pieces.empty();
+}
 
-
+// Subtracts every rectangle in open_0 from dividend, leaving in pieces
+// the disjoint fragments that are not covered by any open rectangle.
+template <typename Event0, typename Rectangle, typename Trace = null_trace>
+void split_against_open (std::vector<Event0> const& open_0, Rectangle dividend
+                         , std::vector<Rectangle>& pieces, std::vector<Rectangle>& scratch
+                         , Trace&& trace = Trace{})
+{
+  pieces.clear();
+  pieces.push_back (dividend);
+  for (auto&& e : open_0)
+  {
+    auto const& divisor = e.interval.rectangle;
+    if (detail::rectangles_overlap (dividend, divisor)
+        && detail::split_pieces (divisor, pieces, scratch, trace))
+      return;
   }
-  //return sweep_interrupt::break_;
-  return sweep_interrupt::continue_;
 }
 
-template <typename Event0>
-algorithm::sweep_interrupt handle_close_0 (std::vector<Event0>& open_0, Event0 close
-                                           , std::multiset<Event0>& set)
+// The same, with the rectangles that overlap dividend found by the
+// overlap kernels over the mirrored coordinates, in the same order,
+// and the pieces split by each of them with split_batch.
+template <typename Event0, typename OpenAllocator, typename Rectangle, typename Allocator
+          , typename Trace = null_trace>
+void split_against_open (open_set<Event0, OpenAllocator>& open_0, Rectangle dividend
+                         , std::vector<Rectangle, Allocator>& pieces, std::vector<Rectangle, Allocator>&
+                         , Trace&& trace = Trace{})
+{
+  pieces.clear();
+  auto& batch = open_0.pieces;
+  batch.clear();
+  batch.push_back (dividend);
+  algorithm::overlap_masks (open_0.coordinates, dividend, open_0.masks);
+  for (std::size_t w = 0; w != open_0.masks.size(); ++w)
+    for (auto mask = open_0.masks[w]; mask != 0; mask &= mask - 1)
+    {
+      auto const& divisor = open_0.events[w * 64 + static_cast<std::size_t>(std::countr_zero (mask))].interval.rectangle;
+      algorithm::split_batch (batch, divisor, open_0.scratch, open_0.codes, trace);
+      batch.swap (open_0.scratch);
+      if (batch.empty())
+        return;
+    }
+  typedef typename rectangle_position<Rectangle>::type position;
+  for (std::size_t i = 0; i != batch.size(); ++i)
+    pieces.push_back ({{static_cast<position>(batch.x1()[i]), static_cast<position>(batch.x2()[i])}
+                       , {static_cast<position>(batch.y1()[i]), static_cast<position>(batch.y2()[i])}});
+}
+
+// A rectangle opens in dim-0. Every rectangle in open_0 is already
+// disjoint from all others, so the opening rectangle is the one that
+// gets split. Fragments that open at the current position become open
+// right away, the ones that open further right are inserted ahead of
+// the sweep cursor and will be handled when the sweep gets there.
+template <typename Event0, typename OpenAllocator, typename Queue, typename Rectangle, typename Allocator
+          , typename Trace>
+void handle_open_0 (open_set<Event0, OpenAllocator>& open_0, Event0 open, Queue& set
+                    , std::vector<Rectangle, Allocator>& pieces, std::vector<Rectangle, Allocator>& scratch
+                    , Trace&& trace)
 {
-  // std::cout << "handle_close_0 close_0 " << close << std::endl;
-  // std::cout << "open_0 (" << open_0.size() << ":" << std::endl;
-  // for (auto& o0 : open_0)
-  //   std::cout << "     elem: " << o0 << std::endl;
+  using algorithm::event_type;
+  using algorithm::event_api::get_position;
   using algorithm::event_api::get_opposite_event;
-  assert (std::find (open_0.begin(), open_0.end(), get_opposite_event(close)) != open_0.end());
-  typedef typename Event0::interval_type::rectangle_type rectangle_type;
-  typedef detail::interval_n<rectangle_type, 1> interval1;
-  typedef exp::algorithm::event<interval1> event1;
+  auto const position = get_position (open);
+
+  detail::split_against_open (open_0, open.interval.rectangle, pieces, scratch, trace);
 
-  std::multiset<event1> overlapped_at_0;
-  for (auto&& e : open_0) // add all events from open intervals but in the next dimension
+  for (auto&& piece : pieces)
   {
-    using exp::algorithm::event_api::get_position;
-    // ignore any intervals that open in the same coordinate as this closes
-    //if (get_position (e) != get_position (close) && e.interval.rectangle != close.interval.rectangle)
-    *exp::algorithm::interval_inserter<event1> (overlapped_at_0) = interval1{e.interval.rectangle};
+    Event0 begin {event_type::begin, {piece}};
+    if (detail::rget_x1 (piece) == position)
+    {
+      begin.interval.handle = open_0.insert (begin);
+      set.insert (get_opposite_event (begin));
+      trace (trace_point::open, piece);
+    }
+    else
+    {
+      assert (position < detail::rget_x1 (piece));
+      set.insert (begin);
+    }
   }
-
-  // std::cout << "overlapped_at_0 (" << overlapped_at_0.size() << "): " << std::endl;
-  // for (auto& o0 : overlapped_at_0)
-  //   std::cout << "     elem: " << o0 << std::endl;
-  
-  using std::placeholders::_1;
-  using std::placeholders::_2;
-  std::vector<event1> actives_1;
-  auto r = algorithm::scan_events (actives_1, overlapped_at_0, nullptr
-                                   , [&open_0, close, &set, &overlapped_at_0] (auto&& a1, auto&& a2)
-                                     { return handle_close_1<event1, Event0>(a1, a2, open_0, close, set, overlapped_at_0); });
-  return r;
 }
 
+// A rectangle closes in dim-0, nothing can overlap it anymore
+template <typename Event0, typename Allocator, typename Trace>
+typename Event0::interval_type::rectangle_type handle_close_0 (open_set<Event0, Allocator>& open_0, Event0 close
+                                                               , Trace&& trace)
+{
+  detail::erase_rectangle (open_0, close.interval.handle, trace);
+  trace (trace_point::close, close.interval.rectangle);
+  return close.interval.rectangle;
 }
-    
-template <typename Container>
-Container rectangle_partition (Container rects)
+
+// The containers of a sweep over an event set of type Queue, all
+// allocated with one allocator. They are cleared, not freed, by each
+// sweep, so a sweep that reuses them allocates only when it needs more
+// than the ones before.
+template <typename Queue, typename Allocator>
+struct sweep_buffers
 {
-  typedef typename Container::value_type rectangle;
-  typedef detail::interval_n<rectangle, 0> interval0;
-  typedef exp::algorithm::event<interval0> event;
-  using exp::algorithm::event_type;
-  std::multiset<event> set;
-  std::copy (rects.begin(), rects.end(), exp::algorithm::interval_inserter<event> (set));
-  
-  std::vector<event> actives;
+  typedef typename Queue::value_type event;
+  typedef typename event::interval_type::rectangle_type rectangle_type;
+  template <typename T>
+  using rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+  explicit sweep_buffers (Allocator const& allocator)
+    : sweep_buffers (allocator, typename Queue::allocator_type (allocator)) {}
+  sweep_buffers (Allocator const& allocator, typename Queue::allocator_type const& queue_allocator)
+    : begins (allocator), sort_scratch (allocator), set (queue_allocator), open_0 (allocator)
+    , pieces (allocator), scratch (allocator) {}
+
+  std::vector<event, rebind<event>> begins, sort_scratch;
+  Queue set;
+  open_set<event, rebind<event>> open_0;
+  std::vector<rectangle_type, rebind<rectangle_type>> pieces, scratch;
+};
 
-  algorithm::sweep_interrupt interrupt = algorithm::sweep_interrupt::break_;
-  while (interrupt == algorithm::sweep_interrupt::break_)
+// The whole sweep over the event set of buffers, which must keep
+// iterators stable when events are inserted after them. The fragments
+// replace the contents of out, which may be rects itself.
+template <typename Input, typename Output, typename Queue, typename Allocator, typename Trace>
+void partition_sweep (Input const& rects, Output& out, sweep_buffers<Queue, Allocator>& buffers, Trace&& trace)
+{
+  using exp::algorithm::event_type;
+  using exp::algorithm::event_api::is_begin_event;
+  auto& begins = buffers.begins;
+  auto& set = buffers.set;
+  auto& open_0 = buffers.open_0;
+  begins.clear();
+  for (auto&& r : rects)
   {
-    actives.clear();
-    interrupt = algorithm::scan_events (actives, set, nullptr,
-                                        [&set] (auto&& a1, auto&& a2)
-                                        { return detail::handle_close_0<event>(a1, a2, set); });
+    // empty rectangles cover no area
+    if (detail::rget_x1 (r) < detail::rget_x2 (r) && detail::rget_y1 (r) < detail::rget_y2 (r))
+      begins.push_back ({event_type::begin, {r}});
   }
+  algorithm::sort_events (begins, buffers.sort_scratch);
+  set.clear();
+  algorithm::insert_sorted_events (set, begins.begin(), begins.end());
+  open_0.clear();
 
-  rects.clear();
-  for (auto && s : set)
+  out.clear();
+  for (auto it = set.begin(); it != set.end(); ++it)
   {
-    if (s.type == event_type::begin)
-      rects.insert (s.interval.rectangle);
+    trace (trace_point::event, it->interval.rectangle);
+    if (is_begin_event (*it))
+      detail::handle_open_0 (open_0, *it, set, buffers.pieces, buffers.scratch, trace);
+    else
+      detail::insert_rectangle (out, detail::handle_close_0 (open_0, *it, trace));
   }
-  
+  assert (open_0.empty());
+}
+
+template <typename Queue, typename Container, typename Allocator, typename Trace>
+Container partition_sweep (Container rects, Allocator const& allocator, Trace&& trace)
+{
+  sweep_buffers<Queue, Allocator> buffers (allocator);
+  detail::partition_sweep (rects, rects, buffers, std::forward<Trace> (trace));
   return rects;
 }
 
-    
+template <typename Rectangle, typename Allocator>
+using partition_queue = btree_multiset<event<interval_n<Rectangle, 0>>, std::less<event<interval_n<Rectangle, 0>>>
+                                       , typename std::allocator_traits<Allocator>::template rebind_alloc
+                                         <event<interval_n<Rectangle, 0>>>>;
+
+}
+
+// Partitions the area covered by rects into disjoint rectangles.
+//
+// The sweep runs once over dim-0. The event set starts with the begin
+// events of the input only, end events are added when a fragment
+// becomes open, and fragments created by a split are always inserted
+// ahead of the current position, so every event is visited once. The
+// event set is a btree_multiset, which keeps the events in contiguous
+// leaves.
+//
+// trace is a policy from sweep_trace.hpp that is told about every
+// event, split, open, close and erase, null_trace by default.
+//
+// allocator, when given, allocates the event set and every temporary of
+// the sweep, for example a std::pmr::polymorphic_allocator over a
+// monotonic_buffer_resource that is released once per frame. Only the
+// returned container uses its own allocator.
+template <typename Allocator, typename Container, typename Trace = null_trace>
+Container rectangle_partition (std::allocator_arg_t, Allocator const& allocator, Container rects
+                               , Trace&& trace = Trace{})
+{
+  return detail::partition_sweep<detail::partition_queue<typename Container::value_type, Allocator>>
+    (std::move (rects), allocator, std::forward<Trace> (trace));
+}
+
+template <typename Container, typename Trace = null_trace>
+Container rectangle_partition (Container rects, Trace&& trace = Trace{})
+{
+  return algorithm::rectangle_partition (std::allocator_arg, std::allocator<typename Container::value_type>()
+                                         , std::move (rects), std::forward<Trace> (trace));
+}
+
+// Everything rectangle_partition allocates, kept between calls for
+// callers that partition every frame. The containers are cleared but
+// keep their capacity, and the event set allocates from a pool that
+// takes back its nodes, so once a workspace has seen the largest input
+// a call does not allocate, as long as the positions are integral.
+// std::stable_sort, used for other positions, takes its own buffer.
+template <typename Rectangle>
+class partition_workspace
+{
+public:
+  typedef std::pmr::polymorphic_allocator<char> allocator_type;
+  typedef detail::sweep_buffers<detail::partition_queue<Rectangle, allocator_type>, allocator_type> buffers_type;
+
+  partition_workspace ()
+    : buffers_ (allocator_type (), allocator_type (&pool)) {}
+  partition_workspace (partition_workspace const&) = delete;
+  partition_workspace& operator= (partition_workspace const&) = delete;
+
+  buffers_type& buffers () { return buffers_; }
+
+private:
+  // nodes of the event set, the other containers keep theirs
+  std::pmr::unsynchronized_pool_resource pool;
+  buffers_type buffers_;
+};
+
+// rectangle_partition with the temporaries of workspace, the fragments
+// replace the contents of out, which also keeps its capacity
+template <typename Rectangle, typename Container, typename Output, typename Trace = null_trace>
+void rectangle_partition (partition_workspace<Rectangle>& workspace, Container const& rects, Output& out
+                          , Trace&& trace = Trace{})
+{
+  detail::partition_sweep (rects, out, workspace.buffers(), std::forward<Trace> (trace));
+}
+
 } }
 
 #endif
@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_SPLIT_BATCH_HPP
+#define ALGORITHM_SPLIT_BATCH_HPP
+
+#include <algorithm/overlap_filter.hpp>
+#include <algorithm/sweep_trace.hpp>
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace exp { namespace algorithm {
+
+namespace detail {
+
+// The fragments split_rectangle leaves for each disposition code, as
+// indices into {ex1, ex2, ey1, ey2, ix1, ix2, iy1, iy2}, e for the
+// dividend and i for the divisor. Codes are closes_after_0 << 3 |
+// closes_after_1 << 2 | opens_before_0 << 1 | opens_before_1, code
+// 16 is a dividend that does not overlap and is kept whole.
+struct split_recipe
+{
+  unsigned char count;
+  unsigned char fragments[4][4];
+};
+
+constexpr std::size_t split_code_keep = 16;
+
+constexpr split_recipe split_recipes[17] =
+{
+  {4, {{0, 1, 2, 6}, {0, 4, 6, 7}, {5, 1, 6, 7}, {0, 1, 7, 3}}},
+  {3, {{0, 1, 7, 3}, {0, 4, 2, 7}, {5, 1, 2, 7}}},
+  {3, {{0, 1, 2, 6}, {5, 1, 6, 7}, {0, 1, 7, 3}}},
+  {2, {{5, 1, 2, 7}, {0, 1, 7, 3}}},
+  {3, {{0, 1, 2, 6}, {0, 4, 6, 3}, {5, 1, 6, 3}}},
+  {2, {{0, 4, 2, 3}, {5, 1, 2, 3}}},
+  {2, {{0, 1, 2, 6}, {5, 1, 6, 3}}},
+  {1, {{5, 1, 2, 3}}},
+  {3, {{0, 1, 2, 6}, {0, 4, 6, 7}, {0, 1, 7, 3}}},
+  {2, {{0, 4, 2, 7}, {0, 1, 7, 3}}},
+  {2, {{0, 1, 2, 6}, {0, 1, 7, 3}}},
+  {1, {{0, 1, 7, 3}}},
+  {2, {{0, 4, 2, 3}, {4, 1, 2, 6}}},
+  {1, {{0, 4, 2, 3}}},
+  {1, {{0, 1, 2, 6}}},
+  {0, {}},
+  {1, {{0, 1, 2, 3}}},
+};
+
+// Writes the disposition code of every dividend from first on
+template <typename Position, typename A>
+void split_codes_scalar (soa_rectangles<Position, A> const& dividends, std::size_t first
+                         , Position ix1, Position ix2, Position iy1, Position iy2
+                         , unsigned char* codes)
+{
+  auto x1 = dividends.x1(), x2 = dividends.x2(), y1 = dividends.y1(), y2 = dividends.y2();
+  for (std::size_t i = first; i != dividends.size(); ++i)
+  {
+    bool overlap = x1[i] < ix2 && y1[i] < iy2 && ix1 < x2[i] && iy1 < y2[i];
+    unsigned code = unsigned (!(ix2 < x2[i])) << 3 | unsigned (!(iy2 < y2[i])) << 2
+      | unsigned (!(x1[i] < ix1)) << 1 | unsigned (!(y1[i] < iy1));
+    codes[i] = static_cast<unsigned char>(overlap ? code : split_code_keep);
+  }
+}
+
+#ifdef ALGORITHM_OVERLAP_FILTER_X86
+
+template <typename Position>
+__attribute__ ((target ("avx2")))
+inline unsigned movemask_256 (__m256i v)
+{
+  return static_cast<unsigned>(sizeof (Position) == 4
+                               ? _mm256_movemask_ps (_mm256_castsi256_ps (v))
+                               : _mm256_movemask_pd (_mm256_castsi256_pd (v)));
+}
+
+// The same compares as split_codes_scalar for 4 or 8 dividends at a
+// time, returns how many dividends it did
+template <typename Position, typename A>
+__attribute__ ((target ("avx2")))
+std::size_t split_codes_avx2 (soa_rectangles<Position, A> const& dividends
+                              , Position ix1, Position ix2, Position iy1, Position iy2
+                              , unsigned char* codes)
+{
+  constexpr std::size_t lanes = 32 / sizeof (Position);
+  auto x1 = dividends.x1(), x2 = dividends.x2(), y1 = dividends.y1(), y2 = dividends.y2();
+  __m256i flip, vx1, vx2, vy1, vy2;
+  if constexpr (sizeof (Position) == 4)
+  {
+    flip = _mm256_set1_epi32 (static_cast<int>(sign_flip<Position>()));
+    vx1 = _mm256_set1_epi32 (static_cast<int>(ix1));
+    vx2 = _mm256_set1_epi32 (static_cast<int>(ix2));
+    vy1 = _mm256_set1_epi32 (static_cast<int>(iy1));
+    vy2 = _mm256_set1_epi32 (static_cast<int>(iy2));
+  }
+  else
+  {
+    flip = _mm256_set1_epi64x (sign_flip<Position>());
+    vx1 = _mm256_set1_epi64x (static_cast<long long>(ix1));
+    vx2 = _mm256_set1_epi64x (static_cast<long long>(ix2));
+    vy1 = _mm256_set1_epi64x (static_cast<long long>(iy1));
+    vy2 = _mm256_set1_epi64x (static_cast<long long>(iy2));
+  }
+  vx1 = _mm256_xor_si256 (vx1, flip);
+  vx2 = _mm256_xor_si256 (vx2, flip);
+  vy1 = _mm256_xor_si256 (vy1, flip);
+  vy2 = _mm256_xor_si256 (vy2, flip);
+
+  std::size_t const whole = dividends.size() / lanes * lanes;
+  for (std::size_t j = 0; j != whole; j += lanes)
+  {
+    __m256i ex1 = load_256 (x1 + j, flip), ex2 = load_256 (x2 + j, flip)
+      , ey1 = load_256 (y1 + j, flip), ey2 = load_256 (y2 + j, flip);
+    unsigned overlap = movemask_256<Position>
+      (_mm256_and_si256 (_mm256_and_si256 (greater_256<Position> (vx2, ex1), greater_256<Position> (vy2, ey1))
+                         , _mm256_and_si256 (greater_256<Position> (ex2, vx1), greater_256<Position> (ey2, vy1))));
+    // set where the disposition bit is not
+    unsigned not_closes_after_0 = movemask_256<Position> (greater_256<Position> (ex2, vx2))
+      , not_closes_after_1 = movemask_256<Position> (greater_256<Position> (ey2, vy2))
+      , not_opens_before_0 = movemask_256<Position> (greater_256<Position> (vx1, ex1))
+      , not_opens_before_1 = movemask_256<Position> (greater_256<Position> (vy1, ey1));
+    for (std::size_t k = 0; k != lanes; ++k)
+    {
+      unsigned code = (~not_closes_after_0 >> k & 1) << 3 | (~not_closes_after_1 >> k & 1) << 2
+        | (~not_opens_before_0 >> k & 1) << 1 | (~not_opens_before_1 >> k & 1);
+      codes[j + k] = static_cast<unsigned char>(overlap >> k & 1 ? code : split_code_keep);
+    }
+  }
+  return whole;
+}
+
+#endif
+
+}
+
+// Splits every rectangle of dividends by divisor as split_rectangle
+// does, writing to out the fragments of the ones that overlap it and
+// the others whole, in order. The disposition of all dividends is
+// computed first, with AVX2 compares when the CPU has them, then the
+// fragments are written in one pass from a table, so there is no
+// branch per disposition. codes is scratch space.
+template <typename Position, typename A, typename Rectangle, typename CodeAllocator, typename Trace = null_trace>
+void split_batch (soa_rectangles<Position, A> const& dividends, Rectangle const& divisor
+                  , soa_rectangles<Position, A>& out, std::vector<unsigned char, CodeAllocator>& codes
+                  , Trace&& trace = Trace{})
+{
+  Position ix1 = detail::rget_x1 (divisor), ix2 = detail::rget_x2 (divisor)
+    , iy1 = detail::rget_y1 (divisor), iy2 = detail::rget_y2 (divisor);
+  std::size_t const n = dividends.size();
+  codes.resize (n);
+  std::size_t done = 0;
+#ifdef ALGORITHM_OVERLAP_FILTER_X86
+  if constexpr (detail::simd_position<Position>::value)
+  {
+    if (algorithm::simd_level::avx2 <= algorithm::detected_simd_level())
+      done = detail::split_codes_avx2 (dividends, ix1, ix2, iy1, iy2, codes.data());
+  }
+#endif
+  detail::split_codes_scalar (dividends, done, ix1, ix2, iy1, iy2, codes.data());
+
+  std::size_t total = 0;
+  for (std::size_t i = 0; i != n; ++i)
+    total += detail::split_recipes[codes[i]].count;
+  out.resize (total);
+
+  auto x1 = dividends.x1(), x2 = dividends.x2(), y1 = dividends.y1(), y2 = dividends.y2();
+  auto ox1 = out.x1(), ox2 = out.x2(), oy1 = out.y1(), oy2 = out.y2();
+  std::size_t o = 0;
+  for (std::size_t i = 0; i != n; ++i)
+  {
+    if constexpr (!std::is_same<typename std::decay<Trace>::type, null_trace>::value)
+    {
+      if (codes[i] != detail::split_code_keep)
+        trace (trace_point::split, Rectangle {{x1[i], x2[i]}, {y1[i], y2[i]}}, divisor);
+    }
+    Position const c[8] = {x1[i], x2[i], y1[i], y2[i], ix1, ix2, iy1, iy2};
+    auto&& recipe = detail::split_recipes[codes[i]];
+    for (unsigned f = 0; f != recipe.count; ++f, ++o)
+    {
+      ox1[o] = c[recipe.fragments[f][0]];
+      ox2[o] = c[recipe.fragments[f][1]];
+      oy1[o] = c[recipe.fragments[f][2]];
+      oy2[o] = c[recipe.fragments[f][3]];
+    }
+  }
+}
+
+} }
+
+#endif
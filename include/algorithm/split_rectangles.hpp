@@ -9,6 +9,12 @@
 #ifndef ALGORITHM_SPLIT_RECTANGLES_HPP
 #define ALGORITHM_SPLIT_RECTANGLES_HPP
 
+#include <array>
+#include <cstddef>
+#include <algorithm>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
 #include <cassert>
 
 namespace exp { namespace algorithm {
@@ -23,6 +29,42 @@ typedef std::integral_constant<rectangle_overlap_disposition, rectangle_overlap_
 typedef std::integral_constant<rectangle_overlap_disposition, rectangle_overlap_disposition::after> overlap_disposition_after_t;
 typedef std::integral_constant<rectangle_overlap_disposition, rectangle_overlap_disposition::across> overlap_disposition_across_t;
 
+// Fragments left of a dividend after a split. A split never leaves
+// more than four fragments, so they are stored inline and splitting
+// does not touch the heap.
+template <typename Rectangle>
+struct split_result
+{
+  typedef Rectangle value_type;
+  typedef Rectangle const* const_iterator;
+  typedef const_iterator iterator;
+  static constexpr std::size_t capacity = 4;
+
+  split_result () = default;
+  split_result (std::initializer_list<Rectangle> l)
+  {
+    assert (l.size() <= capacity);
+    std::copy (l.begin(), l.end(), rectangles.begin());
+    count = static_cast<unsigned char>(l.size());
+  }
+
+  void push_back (Rectangle const& r)
+  {
+    assert (count != capacity);
+    rectangles[count++] = r;
+  }
+
+  const_iterator begin () const { return rectangles.data(); }
+  const_iterator end () const { return rectangles.data() + count; }
+  std::size_t size () const { return count; }
+  bool empty () const { return count == 0; }
+  Rectangle const& operator[](std::size_t i) const { return rectangles[i]; }
+
+private:
+  std::array<Rectangle, capacity> rectangles;
+  unsigned char count = 0;
+};
+
 namespace detail {
 
 template <typename R>
@@ -34,10 +76,41 @@ auto rget_y1 (R&& r) { using algorithm::interval_api::get_interval_begin; return
 template <typename R>
 auto rget_y2 (R&& r) { using algorithm::interval_api::get_interval_end; return get_interval_end(r.i1); }
 
+// the coordinate type of a rectangle
+template <typename Rectangle>
+struct rectangle_position
+{
+  typedef typename std::decay<decltype (detail::rget_y1 (std::declval<Rectangle const&>()))>::type type;
+};
+
+// true if both rectangles share some area, touching borders are not an overlap
+template <typename R>
+bool rectangles_overlap (R const& l, R const& r)
+{
+  return !(rget_x2 (l) <= rget_x1 (r)
+           || rget_y2 (l) <= rget_y1 (r)
+           || rget_x2 (r) <= rget_x1 (l)
+           || rget_y2 (r) <= rget_y1 (l));
+}
+
+// The overlap disposition of dividend against divisor in both
+// dimensions, closes_after_0 << 3 | closes_after_1 << 2 |
+// opens_before_0 << 1 | opens_before_1
+template <typename R>
+unsigned split_code (R const& dividend, R const& divisor)
+{
+  bool closes_after_0 = rget_x2 (divisor) >= rget_x2 (dividend);
+  bool opens_before_0 = rget_x1 (divisor) <= rget_x1 (dividend);
+  bool opens_before_1 = rget_y1 (divisor) <= rget_y1 (dividend);
+  bool closes_after_1 = rget_y2 (divisor) >= rget_y2 (dividend);
+  return static_cast<unsigned>(closes_after_0) << 3 | static_cast<unsigned>(closes_after_1) << 2
+    | static_cast<unsigned>(opens_before_0) << 1 | static_cast<unsigned>(opens_before_1);
+}
+
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_before_t, overlap_disposition_before_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_before_t, overlap_disposition_before_t)
 {
   // ix1       ix2
   //    ex1        ex2
@@ -57,13 +130,12 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
     , ey1 = detail::rget_y1 (dividend)
     , iy2 = detail::rget_y2 (divisor)
     , ey2 = detail::rget_y2 (dividend);
-  std::vector<Rectangle> r;
   assert (ix2 < ex2 && ey1 < iy2 && iy2 < ey2);
   return {{{ix2, ex2}, {ey1, iy2}}, {{ex1, ex2}, {iy2, ey2}}};
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_before_t, overlap_disposition_middle_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_before_t, overlap_disposition_middle_t)
 {
   // ix1             ix2
   //          ex1       ex2
@@ -89,7 +161,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
     
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_before_t, overlap_disposition_after_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_before_t, overlap_disposition_after_t)
 {
     // ix1       ix2
     //    ex1        ex2
@@ -109,7 +181,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
     , ey1 = detail::rget_y1 (dividend)
     , iy1 = detail::rget_y1 (divisor)
     , ey2 = detail::rget_y2 (dividend);
-  std::vector<Rectangle> r;
+  split_result<Rectangle> r;
   assert (ey1 < iy1);
   assert (ix2 < ex2 && iy1 < ey2);
   r.push_back(Rectangle {{ex1, ex2}, {ey1, iy1}});
@@ -118,7 +190,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_before_t, overlap_disposition_across_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_before_t, overlap_disposition_across_t)
 {
     // ix1       ix2
     //    ex1              ex2
@@ -139,12 +211,12 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
     , ex2 = detail::rget_x2 (dividend)
     , ey1 = detail::rget_y1 (dividend)
     , ey2 = detail::rget_y2 (dividend);
-  std::vector<Rectangle> r {Rectangle{{ix2, ex2}, {ey1, ey2}}};
+  split_result<Rectangle> r {Rectangle{{ix2, ex2}, {ey1, ey2}}};
   return r;
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_middle_t, overlap_disposition_before_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_middle_t, overlap_disposition_before_t)
 {
   //     ix1      ix2
   // ex1              ex2
@@ -172,7 +244,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_middle_t, overlap_disposition_middle_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_middle_t, overlap_disposition_middle_t)
 {
   //     ix1      ix2
   // ex1              ex2
@@ -201,7 +273,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_middle_t, overlap_disposition_after_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_middle_t, overlap_disposition_after_t)
 {
   //     ix1      ix2
   // ex1              ex2
@@ -225,12 +297,12 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
     , ey2 = detail::rget_y2 (dividend);
 
   assert (ex1 < ix1 && ix2 < ex2 && ey1 < iy1 && iy1 < ey2);
-  std::vector<Rectangle> r {{{ex1, ex2}, {ey1, iy1}}, {{ex1, ix1}, {iy1, ey2}}, {{ix2, ex2}, {iy1, ey2}}};
+  split_result<Rectangle> r {{{ex1, ex2}, {ey1, iy1}}, {{ex1, ix1}, {iy1, ey2}}, {{ix2, ex2}, {iy1, ey2}}};
   return r;
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_middle_t, overlap_disposition_across_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_middle_t, overlap_disposition_across_t)
 {
   //    ix1       ix2
   // ex1                       ex2
@@ -261,7 +333,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_after_t, overlap_disposition_before_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_after_t, overlap_disposition_before_t)
 {
   // ex1       ex2
   //    ix1        ix2
@@ -285,7 +357,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_after_t, overlap_disposition_middle_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_after_t, overlap_disposition_middle_t)
 {
   // ex1       ex2
   //    ix1              ix2
@@ -313,7 +385,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_after_t, overlap_disposition_after_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_after_t, overlap_disposition_after_t)
 {
   //           ix1     ix2
   //    ex1        ex2
@@ -337,7 +409,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_after_t, overlap_disposition_across_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_after_t, overlap_disposition_across_t)
 {
   //           ix1     ix2
   // ex1           ex2
@@ -363,7 +435,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_across_t, overlap_disposition_before_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_across_t, overlap_disposition_before_t)
 {
   //    ex1       ex2
   // ix1              ix2
@@ -388,7 +460,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_across_t, overlap_disposition_middle_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_across_t, overlap_disposition_middle_t)
 {
   //  ix1                ix2
   //   ex1              ex2
@@ -415,7 +487,7 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 template <typename Rectangle>
-std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_across_t, overlap_disposition_after_t)
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, overlap_disposition_across_t, overlap_disposition_after_t)
 {
   //    ex1       ex2
   // ix1              ix2
@@ -440,6 +512,59 @@ std::vector<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor, o
 }
 
 
+// Splits dividend by divisor choosing the overlap disposition in each
+// dimension at runtime. Both rectangles must overlap.
+template <typename Rectangle>
+split_result<Rectangle> split_rectangle (Rectangle dividend, Rectangle divisor)
+{
+  assert (detail::rectangles_overlap (dividend, divisor));
+
+  switch (detail::split_code (dividend, divisor))
+  {
+  case 0b0000:
+    return split_rectangle (dividend, divisor, overlap_disposition_middle_t{}, overlap_disposition_middle_t{});
+  case 0b0001:
+    return split_rectangle (dividend, divisor, overlap_disposition_middle_t{}, overlap_disposition_before_t{});
+  case 0b0010:
+    return split_rectangle (dividend, divisor, overlap_disposition_before_t{}, overlap_disposition_middle_t{});
+  case 0b0011:
+    return split_rectangle (dividend, divisor, overlap_disposition_before_t{}, overlap_disposition_before_t{});
+  case 0b0100:
+    return split_rectangle (dividend, divisor, overlap_disposition_middle_t{}, overlap_disposition_after_t{});
+  case 0b0101:
+    return split_rectangle (dividend, divisor, overlap_disposition_middle_t{}, overlap_disposition_across_t{});
+  case 0b0110:
+    return split_rectangle (dividend, divisor, overlap_disposition_before_t{}, overlap_disposition_after_t{});
+  case 0b0111:
+    return split_rectangle (dividend, divisor, overlap_disposition_before_t{}, overlap_disposition_across_t{});
+  case 0b1000:
+    return split_rectangle (dividend, divisor, overlap_disposition_after_t{}, overlap_disposition_middle_t{});
+  case 0b1001:
+    return split_rectangle (dividend, divisor, overlap_disposition_after_t{}, overlap_disposition_before_t{});
+  case 0b1010:
+    return split_rectangle (dividend, divisor, overlap_disposition_across_t{}, overlap_disposition_middle_t{});
+  case 0b1011:
+    return split_rectangle (dividend, divisor, overlap_disposition_across_t{}, overlap_disposition_before_t{});
+  case 0b1100:
+    return split_rectangle (dividend, divisor, overlap_disposition_after_t{}, overlap_disposition_after_t{});
+  case 0b1101:
+    return split_rectangle (dividend, divisor, overlap_disposition_after_t{}, overlap_disposition_across_t{});
+  case 0b1110:
+    return split_rectangle (dividend, divisor, overlap_disposition_across_t{}, overlap_disposition_after_t{});
+  default:
+    // completely covers rectangle, nothing is left of it
+    return {};
+  }
+}
+
+// Same as above, but writes the fragments to out
+template <typename Rectangle, typename OutputIterator>
+OutputIterator split_rectangle (Rectangle dividend, Rectangle divisor, OutputIterator out)
+{
+  auto fragments = algorithm::split_rectangle (dividend, divisor);
+  return std::copy (fragments.begin(), fragments.end(), out);
+}
+
 
 } }
 
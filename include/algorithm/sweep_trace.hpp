@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_SWEEP_TRACE_HPP
+#define ALGORITHM_SWEEP_TRACE_HPP
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+
+namespace exp { namespace algorithm {
+
+// Points where the sweeps report to a trace policy. A trace policy is
+// any callable as trace (point, subject) and trace (point, subject, other).
+enum class trace_point
+{
+  event, // the sweep is about to handle subject
+  open,  // subject became open
+  close, // subject closed
+  split, // subject (dividend) is split by other (divisor)
+  erase  // subject was removed from the open rectangles
+};
+
+inline std::ostream& operator<<(std::ostream& os, trace_point p)
+{
+  switch (p)
+  {
+  case trace_point::event:
+    return os << "event";
+  case trace_point::open:
+    return os << "open";
+  case trace_point::close:
+    return os << "close";
+  case trace_point::split:
+    return os << "split";
+  case trace_point::erase:
+    return os << "erase";
+  default:
+    return os << "unknown";
+  }
+}
+
+// Default policy, every call is inlined to nothing
+struct null_trace
+{
+  template <typename... Args>
+  void operator()(trace_point, Args const&...) const {}
+};
+
+// Writes one line per trace point, what scan_events used to print
+struct ostream_trace
+{
+  std::ostream* os;
+
+  template <typename S>
+  void operator()(trace_point p, S const& subject) const
+  {
+    *os << p << " " << subject << '\n';
+  }
+  template <typename S>
+  void operator()(trace_point p, S const& subject, S const& other) const
+  {
+    *os << p << " " << subject << " by " << other << '\n';
+  }
+};
+
+// Keeps the last Capacity trace points, so a failing production input
+// can be inspected without paying for formatting in the sweep.
+template <typename T, std::size_t Capacity>
+struct ring_buffer_trace
+{
+  static_assert (Capacity != 0, "ring_buffer_trace needs room for at least one record");
+
+  struct record
+  {
+    trace_point point;
+    T subject;
+    T other;
+  };
+
+  void operator()(trace_point p, T const& subject)
+  {
+    push ({p, subject, subject});
+  }
+  void operator()(trace_point p, T const& subject, T const& other)
+  {
+    push ({p, subject, other});
+  }
+
+  // number of records kept, at most Capacity
+  std::size_t size () const { return total < Capacity ? total : Capacity; }
+  // number of records ever pushed
+  std::size_t recorded () const { return total; }
+  void clear () { total = 0; }
+
+  // i-th oldest record kept
+  record const& operator[](std::size_t i) const
+  {
+    return records[(total - size() + i) % Capacity];
+  }
+
+  template <typename F>
+  void for_each (F&& f) const
+  {
+    for (std::size_t i = 0; i != size(); ++i)
+      f ((*this)[i]);
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, ring_buffer_trace const& t)
+  {
+    t.for_each ([&os] (record const& r)
+                {
+                  os << r.point << " " << r.subject;
+                  if (r.point == trace_point::split)
+                    os << " by " << r.other;
+                  os << '\n';
+                });
+    return os;
+  }
+
+private:
+  void push (record r)
+  {
+    records[total % Capacity] = r;
+    ++total;
+  }
+
+  std::array<record, Capacity> records;
+  std::size_t total = 0;
+};
+
+} }
+
+#endif
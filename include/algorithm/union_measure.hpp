@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ALGORITHM_UNION_MEASURE_HPP
+#define ALGORITHM_UNION_MEASURE_HPP
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/split_rectangles.hpp>
+#include <algorithm/event_scan.hpp>
+#include <algorithm/event_builder.hpp>
+#include <algorithm/active_set.hpp>
+#include <algorithm/coordinate_compression.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace exp { namespace algorithm {
+
+// Measures of the area covered by a set of rectangles, computed by a
+// sweep over dim-1 with a segment tree over the distinct x coordinates
+// instead of building the fragments. fragments is the number of spans
+// of make_banded_region for the same rectangles.
+template <typename Position>
+struct union_measures
+{
+  typedef decltype (Position() * Position()) area_type;
+
+  area_type area {};
+  Position perimeter {};
+  std::size_t fragments = 0;
+};
+
+namespace detail {
+
+// Segment tree over the elementary x intervals [xs[i], xs[i + 1]),
+// covered by x rank.
+// Each node knows how many rectangles cover all of it, the covered
+// length below it, how many disjoint covered segments it has and
+// whether its ends are covered. It also keeps the coverage below it as
+// it was at the last snapshot, copied when the node is first changed
+// after it, and how many elementary intervals below it are covered in
+// one and not in the other, so whether the spans changed since the
+// snapshot is known exactly at the root.
+template <typename Position>
+class coverage_tree
+{
+public:
+  explicit coverage_tree (std::vector<Position> const& xs)
+    : xs (xs), nodes (xs.size() > 1 ? 4 * (xs.size() - 1) : 1) {}
+
+  // adds delta to the cover count of [xs[lo], xs[hi])
+  void cover (std::size_t lo, std::size_t hi, int delta)
+  {
+    if (lo < hi)
+      cover (1, 0, xs.size() - 1, lo, hi, delta);
+  }
+
+  Position length () const { return nodes[1 % nodes.size()].length; }
+  std::size_t segments () const { return nodes[1 % nodes.size()].segments; }
+
+  // whether the covered x intervals differ from the ones at the last
+  // snapshot
+  bool changed () const { return difference (1 % nodes.size()) != 0; }
+  void snapshot () { ++epoch; }
+
+private:
+  struct node
+  {
+    int count = 0;
+    Position length {};
+    std::size_t segments = 0;
+    bool left_covered = false, right_covered = false;
+    // covered elementary intervals below
+    std::size_t ranks = 0;
+    // count and ranks at the snapshot of epoch, and the elementary
+    // intervals covered at one and not the other
+    int snapshot_count = 0;
+    std::size_t snapshot_ranks = 0;
+    std::size_t difference = 0;
+    std::size_t epoch = 0;
+  };
+
+  // a node not changed since the snapshot is the same as its snapshot
+  std::size_t difference (std::size_t n) const
+  {
+    return nodes[n].epoch == epoch ? nodes[n].difference : 0;
+  }
+
+  void cover (std::size_t n, std::size_t l, std::size_t r, std::size_t lo, std::size_t hi, int delta)
+  {
+    if (hi <= l || r <= lo)
+      return;
+    auto& current = nodes[n];
+    if (current.epoch != epoch)
+    {
+      current.snapshot_count = current.count;
+      current.snapshot_ranks = current.ranks;
+      current.difference = 0;
+      current.epoch = epoch;
+    }
+    if (lo <= l && r <= hi)
+      nodes[n].count += delta;
+    else
+    {
+      std::size_t middle = (l + r) / 2;
+      cover (2 * n, l, middle, lo, hi, delta);
+      cover (2 * n + 1, middle, r, lo, hi, delta);
+    }
+    update (n, l, r);
+  }
+
+  void update (std::size_t n, std::size_t l, std::size_t r)
+  {
+    auto& current = nodes[n];
+    if (current.count > 0)
+    {
+      current.length = xs[r] - xs[l];
+      current.segments = 1;
+      current.left_covered = current.right_covered = true;
+      current.ranks = r - l;
+    }
+    else if (r - l == 1)
+    {
+      current.length = Position {};
+      current.segments = 0;
+      current.left_covered = current.right_covered = false;
+      current.ranks = 0;
+    }
+    else
+    {
+      auto&& left = nodes[2 * n];
+      auto&& right = nodes[2 * n + 1];
+      bool joined = left.right_covered && right.left_covered;
+      current.length = left.length + right.length;
+      current.segments = left.segments + right.segments - (joined ? 1 : 0);
+      current.left_covered = left.left_covered;
+      current.right_covered = right.right_covered;
+      current.ranks = left.ranks + right.ranks;
+    }
+
+    // covered whole at either time, the other one is a subset of it
+    if (current.count > 0 || current.snapshot_count > 0)
+      current.difference = current.ranks > current.snapshot_ranks ? current.ranks - current.snapshot_ranks
+                                                                  : current.snapshot_ranks - current.ranks;
+    else if (r - l == 1)
+      current.difference = 0;
+    else
+      current.difference = difference (2 * n) + difference (2 * n + 1);
+  }
+
+  std::vector<Position> const& xs;
+  std::vector<node> nodes;
+  std::size_t epoch = 0;
+};
+
+}
+
+// Area, perimeter and fragment count of the union of rects in one
+// sweep, O(n log n) time and O(n) memory whatever the size of the
+// output. The sweep runs over compressed rectangles, so the tree is
+// indexed by the x ranks directly and events sort on dense ranks.
+template <typename Container>
+union_measures<typename detail::rectangle_position<typename Container::value_type>::type>
+  measure_union (Container const& rects)
+{
+  typedef typename detail::rectangle_position<typename Container::value_type>::type position;
+  typedef compressed_rectangles<position> compressed;
+  typedef event<detail::interval_n<typename compressed::rectangle, 1>> event1;
+  using algorithm::event_api::get_position;
+
+  auto ranked = algorithm::compress_rectangles (rects);
+  std::vector<event1> events;
+  events.reserve (2 * ranked.rects.size());
+  for (auto&& r : ranked.rects)
+  {
+    if (detail::rget_x1 (r) < detail::rget_x2 (r) && detail::rget_y1 (r) < detail::rget_y2 (r))
+    {
+      events.push_back ({event_type::begin, {r}});
+      events.push_back ({event_type::end, {r}});
+    }
+  }
+  algorithm::sort_events (events);
+
+  union_measures<position> measures;
+  detail::coverage_tree<position> tree (ranked.x.positions());
+  typename compressed::rank_type y = 0;
+  // the band [y, p) ends at every new position p
+  auto reach = [&] (event1 const& e)
+  {
+    auto p = get_position (e);
+    if (p != y)
+    {
+      auto segments = tree.segments();
+      auto height = ranked.y[p] - ranked.y[y];
+      measures.area += tree.length() * height;
+      measures.perimeter += 2 * static_cast<position>(segments) * height;
+      // a band with the spans of the one below extends its fragments
+      if (tree.changed())
+        measures.fragments += segments;
+      tree.snapshot();
+      y = p;
+    }
+    return e.interval.rectangle.i0;
+  };
+
+  // Horizontal edges are the covered length that each event adds or
+  // removes. Begin events come before end events at the same y, so a
+  // rectangle ending where another one begins adds no edge there.
+  auto cover = [&] (typename compressed::interval x, int delta)
+  {
+    auto before = tree.length();
+    tree.cover (x.first, x.second, delta);
+    measures.perimeter += delta > 0 ? tree.length() - before : before - tree.length();
+  };
+
+  if (!events.empty())
+    y = get_position (events.front());
+  algorithm::scan_events (counting_active_set<event1>{}, events
+                          , [&] (auto&&, event1 const& e) { cover (reach (e), 1); }
+                          , [&] (auto&&, event1 const& e) { cover (reach (e), -1); });
+  return measures;
+}
+
+template <typename Container>
+auto union_area (Container const& rects)
+{
+  return algorithm::measure_union (rects).area;
+}
+
+template <typename Container>
+auto union_perimeter (Container const& rects)
+{
+  return algorithm::measure_union (rects).perimeter;
+}
+
+template <typename Container>
+std::size_t union_fragment_count (Container const& rects)
+{
+  return algorithm::measure_union (rects).fragments;
+}
+
+} }
+
+#endif
@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef SUPPORT_ALLOCATION_COUNTER_HPP
+#define SUPPORT_ALLOCATION_COUNTER_HPP
+
+// Replaces the global operator new and delete to count allocations,
+// and to make one of them fail for tests of exception safety. Include
+// it in exactly one translation unit of a test or benchmark.
+
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+
+namespace support {
+
+struct allocation_counter
+{
+  std::size_t allocations = 0;
+  std::size_t bytes = 0;
+  // when not zero, counts down on every allocation and the one that
+  // brings it to zero throws std::bad_alloc
+  std::size_t failing_in = 0;
+};
+
+inline allocation_counter& allocations ()
+{
+  static allocation_counter counter;
+  return counter;
+}
+
+}
+
+void* operator new (std::size_t size)
+{
+  if (support::allocations().failing_in != 0 && --support::allocations().failing_in == 0)
+    throw std::bad_alloc ();
+  ++support::allocations().allocations;
+  support::allocations().bytes += size;
+  if (void* p = std::malloc (size ? size : 1))
+    return p;
+  throw std::bad_alloc ();
+}
+
+void* operator new[] (std::size_t size)
+{
+  return ::operator new (size);
+}
+
+void operator delete (void* p) noexcept
+{
+  std::free (p);
+}
+
+void operator delete[] (void* p) noexcept
+{
+  std::free (p);
+}
+
+void operator delete (void* p, std::size_t) noexcept
+{
+  std::free (p);
+}
+
+void operator delete[] (void* p, std::size_t) noexcept
+{
+  std::free (p);
+}
+
+// memory resources allocate with an alignment
+void* operator new (std::size_t size, std::align_val_t align)
+{
+  if (support::allocations().failing_in != 0 && --support::allocations().failing_in == 0)
+    throw std::bad_alloc ();
+  ++support::allocations().allocations;
+  support::allocations().bytes += size;
+  auto const a = static_cast<std::size_t>(align);
+  if (void* p = std::aligned_alloc (a, (size + a - 1) / a * a))
+    return p;
+  throw std::bad_alloc ();
+}
+
+void operator delete (void* p, std::align_val_t) noexcept
+{
+  std::free (p);
+}
+
+void operator delete (void* p, std::size_t, std::align_val_t) noexcept
+{
+  std::free (p);
+}
+
+#endif
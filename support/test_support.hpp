@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef SUPPORT_TEST_SUPPORT_HPP
+#define SUPPORT_TEST_SUPPORT_HPP
+
+// Helpers shared by the tests and the benchmarks.
+
+#include <vector>
+#include <cassert>
+
+namespace support {
+
+// <random> can't be used together with namespace exp
+inline unsigned next_random (unsigned& state)
+{
+  state = state * 1664525u + 1013904223u;
+  return state >> 8;
+}
+
+// rects are non-empty and cover every unit cell of [0, size)^2 that
+// original covers exactly once, and no other cell
+template <typename Rectangle>
+void check_partition (std::vector<Rectangle> const& original, std::vector<Rectangle> const& rects
+                      , int size)
+{
+  for (auto&& r : rects)
+  {
+    assert (r.i0.first < r.i0.second && r.i1.first < r.i1.second);
+    static_cast<void>(r);
+  }
+  // coordinates are small enough to compare coverage of every unit cell
+  std::vector<int> before (size * size), after (size * size);
+  for (auto&& r : original)
+    for (int x = r.i0.first; x < r.i0.second; ++x)
+      for (int y = r.i1.first; y < r.i1.second; ++y)
+        before[x * size + y] = 1;
+  for (auto&& r : rects)
+    for (int x = r.i0.first; x < r.i0.second; ++x)
+      for (int y = r.i1.first; y < r.i1.second; ++y)
+        ++after[x * size + y];
+  assert (before == after);
+}
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/banded_region.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+typedef exp::algorithm::banded_region<int> region;
+
+using support::next_random;
+
+void check_canonical (region const& r)
+{
+  for (std::size_t i = 0; i != r.bands().size(); ++i)
+  {
+    auto&& b = r.bands()[i];
+    assert (b.y1 < b.y2 && b.first < b.last);
+    for (auto s = r.begin (b); s != r.end (b); ++s)
+      assert (s->first < s->second && (s == r.begin (b) || (s - 1)->second < s->first));
+    if (i != 0)
+    {
+      auto&& previous = r.bands()[i - 1];
+      assert (previous.y2 <= b.y1 && previous.last == b.first);
+      assert (previous.y2 != b.y1 || !std::equal (r.begin (previous), r.end (previous), r.begin (b), r.end (b)));
+    }
+  }
+}
+
+int main()
+{
+  unsigned state = 23;
+  int const size = 48;
+  for (int round = 0; round != 200; ++round)
+  {
+    std::vector<rectangle> rects (next_random (state) % 30);
+    auto coordinate = [&] { return static_cast<int>(next_random (state) % (size + 1)); };
+    for (auto&& r : rects)
+    {
+      auto x1 = coordinate (), x2 = coordinate (), y1 = coordinate (), y2 = coordinate ();
+      r = {{std::min (x1, x2), std::max (x1, x2)}, {std::min (y1, y2), std::max (y1, y2)}};
+    }
+
+    auto banded = exp::algorithm::make_banded_region (rects);
+    check_canonical (banded);
+
+    // covers exactly the cells the rectangles cover
+    std::vector<int> before (size * size), after (size * size);
+    for (auto&& r : rects)
+      for (int x = r.i0.first; x < r.i0.second; ++x)
+        for (int y = r.i1.first; y < r.i1.second; ++y)
+          before[x * size + y] = 1;
+    banded.for_each_rectangle ([&] (int x1, int x2, int y1, int y2)
+                               {
+                                 for (int x = x1; x < x2; ++x)
+                                   for (int y = y1; y < y2; ++y)
+                                     ++after[x * size + y];
+                               });
+    assert (before == after);
+
+    // the same area gives the same region, whatever rectangles cover it
+    auto partition = exp::algorithm::rectangle_partition (rects);
+    assert (exp::algorithm::make_banded_region (partition) == banded);
+    std::reverse (rects.begin(), rects.end());
+    assert (exp::algorithm::make_banded_region (rects) == banded);
+    long area = 0;
+    for (auto&& r : partition)
+      area += long (r.i0.second - r.i0.first) * (r.i1.second - r.i1.first);
+    assert (banded.area() == area);
+  }
+
+  // two touching rectangles of the same width are a single band
+  std::vector<rectangle> stacked {{{0, 4}, {0, 2}}, {{0, 4}, {2, 6}}, {{4, 8}, {0, 6}}};
+  auto single = exp::algorithm::make_banded_region (stacked);
+  assert (single.bands().size() == 1 && single.spans().size() == 1);
+  assert (single.spans()[0] == interval (0, 8) && single.bands()[0].y1 == 0 && single.bands()[0].y2 == 6);
+  assert (exp::algorithm::make_banded_region (std::vector<rectangle> ()).empty());
+
+  std::cout << "banded regions are canonical" << std::endl;
+  return 0;
+}
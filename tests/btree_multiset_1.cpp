@@ -0,0 +1,147 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/btree_multiset.hpp>
+
+#include <set>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <cassert>
+
+using support::next_random;
+
+// ordered by first only, second tells equivalent values apart
+typedef std::pair<int, int> value;
+struct by_first
+{
+  bool operator()(value const& l, value const& r) const { return l.first < r.first; }
+};
+
+// small nodes so a few hundred values already make a deep tree
+typedef exp::algorithm::btree_multiset<value, by_first, std::allocator<value>, 64> btree;
+
+template <typename L, typename R>
+bool same (L const& l, R const& r)
+{
+  return l.size() == r.size() && std::equal (l.begin(), l.end(), r.begin())
+    && std::equal (l.rbegin(), l.rend(), r.rbegin());
+}
+
+int main()
+{
+  unsigned state = 5;
+  btree tree;
+  std::multiset<value, by_first> reference;
+  assert (tree.begin() == tree.end());
+
+  for (int round = 0; round != 20000; ++round)
+  {
+    value v {static_cast<int>(next_random (state) % 500), round};
+    if (next_random (state) % 3 != 0 || reference.empty())
+    {
+      auto it = tree.insert (v);
+      reference.insert (v);
+      assert (*it == v);
+    }
+    else
+    {
+      auto it = tree.find (v);
+      assert ((it == tree.end()) == (reference.find (v) == reference.end()));
+      assert (it == tree.end() || *it == *reference.lower_bound (v));
+      if (it != tree.end())
+      {
+        // erase removes the first equivalent value, like the reference
+        reference.erase (reference.lower_bound (v));
+        tree.erase (it);
+      }
+    }
+    int key = next_random (state) % 510;
+    assert (tree.count ({key, 0}) == reference.count ({key, 0}));
+    auto lower = tree.lower_bound ({key, 0});
+    auto upper = tree.upper_bound ({key, 0});
+    assert ((lower == tree.end()) == (reference.lower_bound ({key, 0}) == reference.end()));
+    assert ((upper == tree.end()) == (reference.upper_bound ({key, 0}) == reference.end()));
+    assert (lower == tree.end() || *lower == *reference.lower_bound ({key, 0}));
+    assert (upper == tree.end() || *upper == *reference.upper_bound ({key, 0}));
+  }
+  assert (same (tree, reference));
+  assert (tree.erase ({7, 0}) == reference.erase ({7, 0}));
+  assert (same (tree, reference));
+
+  // copies and moves keep the values and leave a working tree behind
+  btree copy (tree);
+  assert (same (copy, reference));
+  btree moved (std::move (copy));
+  assert (same (moved, reference));
+  assert (copy.empty() && copy.begin() == copy.end());
+  copy.insert ({1, 1});
+  assert (copy.size() == 1 && *copy.begin() == value (1, 1));
+  swap (copy, moved);
+  assert (same (copy, reference));
+  moved.clear();
+  assert (moved.empty() && moved.begin() == moved.end());
+
+  // bulk loads of every shape: one leaf, full and partial inner nodes
+  for (int n = 0; n < 3000; n += 1 + n / 4)
+  {
+    std::vector<value> sorted;
+    for (int i = 0; i != n; ++i)
+      sorted.push_back ({i / 3, i});
+    btree loaded;
+    loaded.assign_sorted (sorted.begin(), sorted.end());
+    assert (same (loaded, sorted));
+    for (int i = 0; i < n; i += 7)
+      assert (loaded.lower_bound ({i / 3, 0})->first == i / 3);
+    loaded.insert ({n, n});
+    sorted.push_back ({n, n});
+    assert (same (loaded, sorted));
+  }
+
+  // hinted at the end, values go where std::multiset puts them, whether
+  // they append or not
+  btree hinted;
+  std::multiset<value, by_first> hinted_reference;
+  for (int i = 0; i != 3000; ++i)
+  {
+    value v {i / 4 - (next_random (state) % 10 == 0 ? static_cast<int>(next_random (state) % 100) : 0), i};
+    auto it = hinted.insert (hinted.end(), v);
+    hinted_reference.insert (hinted_reference.end(), v);
+    assert (*it == v);
+  }
+  assert (same (hinted, hinted_reference));
+
+  // A sweep inserts events ahead of its cursor while iterating, the
+  // cursor and every value before it must stay where they are.
+  btree events;
+  for (int i = 0; i != 200; ++i)
+    events.insert ({static_cast<int>(next_random (state) % 1000), i});
+  std::vector<btree::const_iterator> visited;
+  std::vector<value> values;
+  int inserted = 0;
+  for (auto it = events.begin(); it != events.end(); ++it)
+  {
+    visited.push_back (it);
+    values.push_back (*it);
+    if (inserted != 2000)
+    {
+      // equivalent values go after the cursor too
+      events.insert ({it->first + static_cast<int>(next_random (state) % 50), 1000 + inserted++});
+      events.insert ({it->first, 1000 + inserted++});
+    }
+    for (std::size_t i = 0; i < visited.size(); i += 1 + visited.size() / 8)
+      assert (*visited[i] == values[i]);
+  }
+  assert (values.size() == events.size());
+  assert (std::is_sorted (values.begin(), values.end(), by_first()));
+
+  std::cout << "btree_multiset of " << tree.size() << " values in " << tree.memory_usage() << " bytes" << std::endl;
+  return 0;
+}
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/coalesce.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <set>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+bool mergeable (rectangle const& l, rectangle const& r)
+{
+  return (l.i0 == r.i0 && (l.i1.second == r.i1.first || r.i1.second == l.i1.first))
+    || (l.i1 == r.i1 && (l.i0.second == r.i0.first || r.i0.second == l.i0.first));
+}
+
+int main()
+{
+  unsigned state = 41;
+  int const size = 40;
+  std::size_t before = 0, after = 0;
+  for (int round = 0; round != 200; ++round)
+  {
+    std::vector<rectangle> rects (next_random (state) % 30);
+    auto coordinate = [&] { return static_cast<int>(next_random (state) % (size + 1)); };
+    for (auto&& r : rects)
+    {
+      auto x1 = coordinate (), x2 = coordinate (), y1 = coordinate (), y2 = coordinate ();
+      r = {{std::min (x1, x2), std::max (x1, x2)}, {std::min (y1, y2), std::max (y1, y2)}};
+    }
+
+    auto partition = exp::algorithm::rectangle_partition (rects);
+    auto coalesced = exp::algorithm::coalesce_rectangles (partition);
+    assert (coalesced == exp::algorithm::coalesced_rectangle_partition (rects));
+    assert (coalesced.size() <= partition.size());
+    before += partition.size();
+    after += coalesced.size();
+
+    // still disjoint and covering the same cells, and with enough passes
+    // nothing is left to merge
+    std::vector<int> covered (size * size), cells (size * size);
+    for (auto&& r : rects)
+      for (int x = r.i0.first; x < r.i0.second; ++x)
+        for (int y = r.i1.first; y < r.i1.second; ++y)
+          covered[x * size + y] = 1;
+    for (auto&& r : coalesced)
+      for (int x = r.i0.first; x < r.i0.second; ++x)
+        for (int y = r.i1.first; y < r.i1.second; ++y)
+          ++cells[x * size + y];
+    assert (covered == cells);
+    auto complete = exp::algorithm::coalesce_rectangles (partition, partition.size() + 1);
+    assert (complete.size() <= coalesced.size());
+    for (std::size_t i = 0; i != complete.size(); ++i)
+      for (std::size_t j = i + 1; j != complete.size(); ++j)
+        assert (!mergeable (complete[i], complete[j]));
+
+    // and the same for ordered containers
+    std::multiset<rectangle> set (partition.begin(), partition.end());
+    assert (exp::algorithm::coalesce_rectangles (set).size() == coalesced.size());
+  }
+  assert (after < before);
+
+  // a column cut in three and a row cut in two
+  std::vector<rectangle> column {{{0, 2}, {0, 1}}, {{0, 2}, {1, 3}}, {{0, 2}, {3, 4}}, {{2, 5}, {0, 4}}};
+  auto merged = exp::algorithm::coalesce_rectangles (column);
+  assert (merged.size() == 1 && merged[0] == (rectangle {{0, 5}, {0, 4}}));
+  // one pass only merges along y
+  merged = exp::algorithm::coalesce_rectangles (column, 1);
+  assert (merged.size() == 2);
+  assert (exp::algorithm::coalesce_rectangles (column, 0).size() == column.size());
+
+  std::cout << "coalescing keeps the area with fewer rectangles" << std::endl;
+  return 0;
+}
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/coordinate_compression.hpp>
+#include <algorithm/union_measure.hpp>
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<long, long> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+int main()
+{
+  std::vector<int> values {7, -3, 7, 100, 0, -3};
+  exp::algorithm::coordinate_compression<int> compression (values.begin(), values.end());
+  assert (compression.size() == 4);
+  assert ((compression.positions() == std::vector<int> {-3, 0, 7, 100}));
+  assert (compression.rank (-3) == 0 && compression.rank (100) == 3);
+  assert (compression.position (2) == 7 && compression[1] == 0);
+  assert (compression.contains (0) && !compression.contains (1));
+  assert (exp::algorithm::coordinate_compression<int> ().empty());
+
+  unsigned state = 11;
+  for (int round = 0; round != 100; ++round)
+  {
+    // sparse coordinates far apart, the ranks keep only their order
+    std::vector<rectangle> rects (next_random (state) % 40);
+    auto coordinate = [&] { return static_cast<long>(next_random (state) % 16) * 1000003l - 7000000l; };
+    for (auto&& r : rects)
+    {
+      auto x1 = coordinate (), x2 = coordinate (), y1 = coordinate (), y2 = coordinate ();
+      r = {{std::min (x1, x2), std::max (x1, x2)}, {std::min (y1, y2), std::max (y1, y2)}};
+    }
+
+    auto ranked = exp::algorithm::compress_rectangles (rects);
+    assert (ranked.rects.size() == rects.size());
+    for (std::size_t i = 0; i != rects.size(); ++i)
+    {
+      auto&& r = ranked.rects[i];
+      assert (ranked.decompress<rectangle> (r) == rects[i]);
+      assert (r.i0.first == ranked.x.rank (rects[i].i0.first) && r.i1.second == ranked.y.rank (rects[i].i1.second));
+      // order and equality between ranks is the same as between coordinates
+      for (std::size_t j = 0; j != rects.size(); ++j)
+      {
+        assert ((r.i0.first < ranked.rects[j].i0.second) == (rects[i].i0.first < rects[j].i0.second));
+        assert ((r.i1.second == ranked.rects[j].i1.first) == (rects[i].i1.second == rects[j].i1.first));
+      }
+    }
+    for (std::size_t k = 1; k < ranked.x.size(); ++k)
+      assert (ranked.x[k - 1] < ranked.x[k]);
+
+    // fragment counts only depend on the order of the coordinates
+    std::vector<rectangle> dense;
+    for (auto&& r : ranked.rects)
+      dense.push_back ({{r.i0.first, r.i0.second}, {r.i1.first, r.i1.second}});
+    assert (exp::algorithm::union_fragment_count (dense) == exp::algorithm::union_fragment_count (rects));
+  }
+
+  std::cout << "coordinates compress to dense ranks" << std::endl;
+  return 0;
+}
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/dynamic_partition.hpp>
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+int const size = 48;
+
+// the fragments are disjoint and cover the cells the inputs cover
+void check (exp::algorithm::dynamic_rectangle_partition<rectangle> const& partition
+            , std::vector<rectangle> const& inputs)
+{
+  std::vector<int> covered (size * size), cells (size * size);
+  for (auto&& r : inputs)
+    for (int x = r.i0.first; x < r.i0.second; ++x)
+      for (int y = r.i1.first; y < r.i1.second; ++y)
+        covered[x * size + y] = 1;
+  for (auto&& r : partition.fragments())
+  {
+    assert (r.i0.first < r.i0.second && r.i1.first < r.i1.second);
+    for (int x = r.i0.first; x < r.i0.second; ++x)
+      for (int y = r.i1.first; y < r.i1.second; ++y)
+        ++cells[x * size + y];
+  }
+  assert (covered == cells);
+  assert (partition.size() == inputs.size());
+}
+
+int main()
+{
+  unsigned state = 19;
+  for (int round = 0; round != 40; ++round)
+  {
+    exp::algorithm::dynamic_rectangle_partition<rectangle> partition;
+    std::vector<rectangle> inputs;
+    auto coordinate = [&] { return static_cast<int>(next_random (state) % (size + 1)); };
+    for (int update = 0; update != 60; ++update)
+    {
+      if (inputs.empty() || next_random (state) % 5 < 3)
+      {
+        auto x1 = coordinate (), x2 = coordinate (), y1 = coordinate (), y2 = coordinate ();
+        rectangle r {{std::min (x1, x2), std::max (x1, x2)}, {std::min (y1, y2), std::max (y1, y2)}};
+        // sometimes the same rectangle twice
+        if (!inputs.empty() && next_random (state) % 8 == 0)
+          r = inputs[next_random (state) % inputs.size()];
+        partition.insert (r);
+        inputs.push_back (r);
+      }
+      else
+      {
+        auto at = next_random (state) % inputs.size();
+        assert (partition.erase (inputs[at]));
+        inputs.erase (inputs.begin() + at);
+      }
+      check (partition, inputs);
+    }
+    assert (!partition.erase ({{size + 1, size + 2}, {0, 1}}));
+
+    // built at once, it covers the same area
+    exp::algorithm::dynamic_rectangle_partition<rectangle> built (inputs);
+    check (built, inputs);
+    while (!inputs.empty())
+    {
+      assert (partition.erase (inputs.back()));
+      inputs.pop_back();
+    }
+    assert (partition.empty() && partition.fragments().empty());
+  }
+
+  // one rectangle covering everything under many small ones changing,
+  // like a full screen damage among a few widgets
+  {
+    exp::algorithm::dynamic_rectangle_partition<rectangle> partition;
+    std::vector<rectangle> inputs {{{0, size}, {0, size}}};
+    partition.insert (inputs.front());
+    for (int update = 0; update != 400; ++update)
+    {
+      if (inputs.size() == 1 || next_random (state) % 3 != 0)
+      {
+        int x = static_cast<int>(next_random (state) % (size - 4)), y = static_cast<int>(next_random (state) % (size - 4));
+        rectangle r {{x, x + 1 + static_cast<int>(next_random (state) % 4)}, {y, y + 1 + static_cast<int>(next_random (state) % 4)}};
+        partition.insert (r);
+        inputs.push_back (r);
+      }
+      else
+      {
+        auto at = 1 + next_random (state) % (inputs.size() - 1);
+        assert (partition.erase (inputs[at]));
+        inputs.erase (inputs.begin() + at);
+      }
+      check (partition, inputs);
+    }
+    // the small ones take over the area of the wide one
+    assert (partition.erase (inputs.front()));
+    inputs.erase (inputs.begin());
+    check (partition, inputs);
+  }
+
+  std::cout << "dynamic partition follows its inputs" << std::endl;
+  return 0;
+}
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/event_builder.hpp>
+#include <algorithm/btree_multiset.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <set>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+using support::next_random;
+
+// make_events must give the sequence interval_inserter builds in a
+// std::multiset, equivalent events included
+template <typename Interval>
+void compare_with_inserter (std::vector<Interval> const& intervals)
+{
+  typedef exp::algorithm::event<Interval> event;
+  std::multiset<event> set;
+  std::copy (intervals.begin(), intervals.end(), exp::algorithm::interval_inserter<event> (set));
+
+  auto events = exp::algorithm::make_events<event> (intervals.begin(), intervals.end());
+  assert (events.size() == set.size());
+  assert (std::equal (events.begin(), events.end(), set.begin()));
+
+  exp::algorithm::btree_multiset<event> btree;
+  exp::algorithm::insert_intervals<event> (btree, intervals.begin(), intervals.end());
+  assert (std::equal (btree.begin(), btree.end(), set.begin(), set.end()));
+
+  // merging into containers that already hold events
+  std::vector<event> vector;
+  std::multiset<event> merged;
+  auto middle = intervals.begin() + intervals.size() / 2;
+  exp::algorithm::insert_intervals<event> (vector, intervals.begin(), middle);
+  exp::algorithm::insert_intervals<event> (vector, middle, intervals.end());
+  exp::algorithm::insert_intervals<event> (merged, intervals.begin(), middle);
+  exp::algorithm::insert_intervals<event> (merged, middle, intervals.end());
+  exp::algorithm::insert_intervals<event> (btree, intervals.begin(), middle);
+  assert (std::is_sorted (vector.begin(), vector.end()));
+  assert (std::is_sorted (btree.begin(), btree.end()));
+  assert (vector.size() == set.size() && merged.size() == set.size());
+  assert (std::equal (vector.begin(), vector.end(), merged.begin()));
+}
+
+int main()
+{
+  unsigned state = 17;
+
+  // negative positions, many equal begins and ends
+  std::vector<std::pair<int, int>> ints;
+  for (int i = 0; i != 3000; ++i)
+  {
+    int begin = static_cast<int>(next_random (state) % 200) - 100;
+    ints.push_back ({begin, begin + 1 + static_cast<int>(next_random (state) % 20)});
+  }
+  compare_with_inserter (ints);
+
+  // wide positions use every radix digit
+  std::vector<std::pair<long long, long long>> wide;
+  for (int i = 0; i != 3000; ++i)
+  {
+    long long begin = (static_cast<long long>(next_random (state)) << 30) - (1ll << 50);
+    wide.push_back ({begin, begin + static_cast<long long>(next_random (state) % 3)});
+  }
+  compare_with_inserter (wide);
+
+  // floating point positions are sorted by comparison
+  std::vector<std::pair<double, double>> reals;
+  for (int i = 0; i != 3000; ++i)
+  {
+    double begin = static_cast<double>(next_random (state) % 100) / 4;
+    reals.push_back ({begin, begin + 0.25});
+  }
+  compare_with_inserter (reals);
+
+  // rectangles build events of interval_n
+  typedef std::pair<int, int> interval;
+  typedef exp::algorithm::rectangle<interval, interval> rectangle;
+  typedef exp::algorithm::event<exp::algorithm::detail::interval_n<rectangle, 0>> event0;
+  std::vector<rectangle> rects;
+  for (int i = 0; i != 1000; ++i)
+  {
+    int x = next_random (state) % 50, y = next_random (state) % 50;
+    rects.push_back ({{x, x + 1 + static_cast<int>(next_random (state) % 5)}, {y, y + 1}});
+  }
+  auto begins = exp::algorithm::make_begin_events<event0> (rects.begin(), rects.end());
+  std::multiset<event0> set;
+  for (auto&& r : rects)
+    set.insert ({exp::algorithm::event_type::begin, {r}});
+  assert (std::equal (begins.begin(), begins.end(), set.begin(), set.end()));
+
+  std::cout << "built " << ints.size() + wide.size() + reals.size() << " interval events and "
+            << begins.size() << " rectangle events" << std::endl;
+  return 0;
+}
@@ -11,13 +11,16 @@
 #include <set>
 #include <vector>
 #include <iostream>
+#include <cassert>
 
-int main()
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::event<interval> event;
+
+template <typename ActiveContainer>
+void scan ()
 {
-  typedef std::pair<int, int> interval;
-  typedef exp::algorithm::event<interval> event;
   std::multiset<event> set;
-  std::vector<event> actives;
+  ActiveContainer actives;
 
   std::vector<interval> intervals {{0, 5}, {0, 10}, {20, 30}, {0, 25}};
   std::copy (intervals.begin(), intervals.end(), exp::algorithm::interval_inserter<event> (set));
@@ -43,6 +46,14 @@ int main()
          std::cout << "] " << e << std::endl;
        }
      );
+  assert (actives.empty());
+}
 
+int main()
+{
+  scan<std::vector<event>>();
+  scan<std::multiset<event>>();
+  scan<exp::algorithm::tombstone_active_set<event>>();
+  scan<exp::algorithm::btree_multiset<event>>();
   return 0;
 }
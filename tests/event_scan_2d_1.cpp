@@ -88,7 +88,11 @@ int get_interval_end (interval<1> i)
   return i.rectangle.y2;
 }
 
-int main()
+template <typename T>
+using btree_actives = exp::algorithm::btree_multiset<T>;
+
+template <template <typename...> class Actives>
+std::set<std::pair<rectangle, rectangle>> scan ()
 {
   using exp::algorithm::event_type;
   typedef interval<0> interval_0;
@@ -96,9 +100,9 @@ int main()
   typedef exp::algorithm::event<interval_0> event_0;
   typedef exp::algorithm::event<interval_1> event_1;
   std::multiset<event_0> set;
-  std::vector<event_0> actives_0;
+  Actives<event_0> actives_0;
   std::vector<event_1> overlapped_0;
-  std::vector<event_1> actives_1;
+  Actives<event_1> actives_1;
   std::set<rectangle> overlapped_regions;
 
   std::set<std::pair<rectangle, rectangle>> edges;
@@ -161,5 +165,14 @@ int main()
   std::cout << "edges: " << edges.size() << std::endl;
 
   std::cout << "finsihed" << std::endl;
+  return edges;
+}
+
+int main()
+{
+  auto edges = scan<std::vector>();
+  assert (scan<std::multiset>() == edges);
+  assert (scan<exp::algorithm::tombstone_active_set>() == edges);
+  assert (scan<btree_actives>() == edges);
   return 0;
 }
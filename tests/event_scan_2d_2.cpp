@@ -416,7 +416,11 @@ void handle_after_before (std::vector<rectangle> v
   }
 }
 
-int main()
+template <typename T>
+using btree_actives = exp::algorithm::btree_multiset<T>;
+
+template <template <typename...> class Actives>
+std::set<rectangle> scan ()
 {
   using exp::algorithm::event_type;
   typedef interval<0> interval_0;
@@ -424,9 +428,9 @@ int main()
   typedef exp::algorithm::event<interval_0> event_0;
   typedef exp::algorithm::event<interval_1> event_1;
   std::multiset<event_0> set;
-  std::vector<event_0> actives_0;
+  Actives<event_0> actives_0;
   std::vector<event_1> overlapped_0;
-  std::vector<event_1> actives_1;
+  Actives<event_1> actives_1;
   std::set<rectangle> overlapped_regions;
 
   std::set<std::pair<rectangle, rectangle>> edges;
@@ -644,5 +648,14 @@ int main()
 
   std::cout << "finsihed bigger_x: " << bigger_x << " bigger_y: " << bigger_y << " area " << area << std::endl;
 
+  return rects;
+}
+
+int main()
+{
+  auto rects = scan<std::vector>();
+  assert (scan<std::multiset>() == rects);
+  assert (scan<exp::algorithm::tombstone_active_set>() == rects);
+  assert (scan<btree_actives>() == rects);
   return 0;
 }
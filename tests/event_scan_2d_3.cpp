@@ -450,7 +450,11 @@ void add_regions (std::multiset<exp::algorithm::event<interval<0>>>& set)
 }
                   
 
-int main()
+template <typename T>
+using btree_actives = exp::algorithm::btree_multiset<T>;
+
+template <template <typename...> class Actives>
+std::set<rectangle> scan ()
 {
   using exp::algorithm::event_type;
   typedef interval<0> interval_0;
@@ -458,9 +462,9 @@ int main()
   typedef exp::algorithm::event<interval_0> event_0;
   typedef exp::algorithm::event<interval_1> event_1;
   std::multiset<event_0> set;
-  std::vector<event_0> actives_0;
+  Actives<event_0> actives_0;
   std::vector<event_1> overlapped_0;
-  std::vector<event_1> actives_1;
+  Actives<event_1> actives_1;
   std::set<rectangle> overlapped_regions;
 
   std::set<std::pair<rectangle, rectangle>> edges;
@@ -619,5 +623,14 @@ int main()
 
   std::cout << "finsihed bigger_x: " << bigger_x << " bigger_y: " << bigger_y << " area " << area << std::endl;
 
+  return rects;
+}
+
+int main()
+{
+  auto rects = scan<std::vector>();
+  assert (scan<std::multiset>() == rects);
+  assert (scan<exp::algorithm::tombstone_active_set>() == rects);
+  assert (scan<btree_actives>() == rects);
   return 0;
 }
@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/allocation_counter.hpp"
+#include "../support/test_support.hpp"
+
+#include <algorithm/event_scan.hpp>
+#include <algorithm/event_builder.hpp>
+#include <algorithm/btree_multiset.hpp>
+
+#include <set>
+#include <tuple>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::event<interval> event;
+// open or close, the event and the actives when it was called
+typedef std::tuple<bool, event, std::size_t> call;
+
+using support::next_random;
+
+template <typename ActiveContainer>
+void compare (std::vector<interval> const& intervals)
+{
+  std::vector<call> expected, streamed;
+  {
+    ActiveContainer actives;
+    auto events = exp::algorithm::make_events<event> (intervals.begin(), intervals.end());
+    exp::algorithm::scan_events (actives, events
+                                 , [&] (auto&& a, event const& e) { expected.push_back ({true, e, a.size()}); }
+                                 , [&] (auto&& a, event const& e) { expected.push_back ({false, e, a.size()}); });
+  }
+  ActiveContainer actives;
+  exp::algorithm::scan_intervals<event> (actives, intervals.begin(), intervals.end()
+                                         , [&] (auto&& a, event const& e) { streamed.push_back ({true, e, a.size()}); }
+                                         , [&] (auto&& a, event const& e) { streamed.push_back ({false, e, a.size()}); });
+  assert (actives.empty());
+  assert (streamed == expected);
+
+  // without open only the closes are left
+  std::size_t closes = 0;
+  exp::algorithm::scan_intervals<event> (actives, intervals.begin(), intervals.end(), nullptr
+                                         , [&] (auto&&, event const&) { ++closes; });
+  assert (closes == intervals.size());
+}
+
+int main()
+{
+  unsigned state = 41;
+  for (int round = 0; round != 20; ++round)
+  {
+    // ties in begin and in end, sorted as make_events sorts them
+    std::vector<interval> intervals (200);
+    for (auto& i : intervals)
+    {
+      i.first = static_cast<int>(next_random (state) % 100);
+      i.second = i.first + static_cast<int>(next_random (state) % 20);
+    }
+    std::sort (intervals.begin(), intervals.end());
+    compare<std::vector<event>> (intervals);
+    compare<std::multiset<event>> (intervals);
+    compare<exp::algorithm::btree_multiset<event>> (intervals);
+  }
+
+  // a long stream with few intervals open at once allocates for those
+  // only, the heap grows a few times and then stays
+  std::vector<interval> stream (100000);
+  int at = 0;
+  for (auto& i : stream)
+  {
+    at += static_cast<int>(next_random (state) % 3);
+    i = {at, at + 1 + static_cast<int>(next_random (state) % 8)};
+  }
+  std::vector<event> actives;
+  actives.reserve (64);
+  std::size_t most = 0;
+  auto before = support::allocations().allocations;
+  exp::algorithm::scan_intervals<event> (actives, stream.begin(), stream.end(), nullptr
+                                         , [&] (auto&& a, event const&) { most = std::max (most, a.size()); });
+  assert (most <= 64);
+  assert (support::allocations().allocations - before <= 8);
+
+  std::cout << "streaming scan matches scan_events with at most " << most << " intervals open" << std::endl;
+  return 0;
+}
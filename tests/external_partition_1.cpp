@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/external_partition.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+void write_rectangles (std::string const& path, std::vector<rectangle> const& rects)
+{
+  std::ofstream file (path, std::ios::binary);
+  file.write (reinterpret_cast<char const*>(rects.data()), static_cast<std::streamsize>(rects.size() * sizeof (rectangle)));
+}
+
+std::vector<rectangle> read_rectangles (std::string const& path)
+{
+  std::vector<rectangle> rects (std::filesystem::file_size (path) / sizeof (rectangle));
+  std::ifstream file (path, std::ios::binary);
+  file.read (reinterpret_cast<char*>(rects.data()), static_cast<std::streamsize>(rects.size() * sizeof (rectangle)));
+  return rects;
+}
+
+int main()
+{
+  auto directory = std::filesystem::temp_directory_path().string();
+  std::string input = directory + "/external_partition_1.in", output = directory + "/external_partition_1.out";
+  // the runs go to $TMPDIR or /tmp by default
+  exp::algorithm::external_partition_options options;
+  assert (!options.temporary_directory.empty() && options.temporary_directory != ".");
+
+  unsigned state = 5;
+  for (std::size_t n : {0, 1, 50, 3000})
+  {
+    std::vector<rectangle> rects (n);
+    for (auto&& r : rects)
+    {
+      int x = static_cast<int>(next_random (state) % 1000), y = static_cast<int>(next_random (state) % 1000);
+      // some empty, some equal to others
+      r = {{x, x + static_cast<int>(next_random (state) % 60)}, {y, y + 1 + static_cast<int>(next_random (state) % 60)}};
+      if (next_random (state) % 10 == 0 && &r != &rects[0])
+        r = (&r)[-1];
+    }
+    write_rectangles (input, rects);
+    auto expected = exp::algorithm::rectangle_partition (rects);
+
+    // the default budget takes everything in one run, the smallest one
+    // needs many runs merged in passes
+    for (std::size_t budget : {std::size_t (64) << 20, std::size_t (4096), std::size_t (20000)})
+    {
+      options.memory_budget = budget;
+      auto stats = exp::algorithm::external_rectangle_partition<rectangle> (input.c_str(), output.c_str(), options);
+      assert (stats.rectangles == n);
+      assert (stats.fragments == expected.size());
+      assert (read_rectangles (output) == expected);
+      if (n == 3000 && budget == 4096)
+        assert (stats.runs > 2 && stats.merge_passes != 0);
+    }
+  }
+
+  // a missing input is an error
+  bool thrown = false;
+  try
+  {
+    exp::algorithm::external_rectangle_partition<rectangle> ((directory + "/no such file").c_str(), output.c_str(), options);
+  }
+  catch (std::system_error const&)
+  {
+    thrown = true;
+  }
+  assert (thrown);
+
+  std::filesystem::remove (input);
+  std::filesystem::remove (output);
+  std::cout << "external partition writes what rectangle_partition returns" << std::endl;
+  return 0;
+}
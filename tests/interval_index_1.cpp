@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/interval_index.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+
+using support::next_random;
+
+struct entry
+{
+  int begin, end;
+  std::size_t id;
+};
+
+int main()
+{
+  unsigned state = 23;
+  exp::algorithm::interval_index<int> index;
+  std::vector<entry> reference;
+  std::size_t next_id = 0;
+  for (int round = 0; round != 4000; ++round)
+  {
+    if (reference.empty() || next_random (state) % 3 != 0)
+    {
+      int begin = static_cast<int>(next_random (state) % 1000);
+      // mostly short, sometimes one spanning nearly everything
+      int width = next_random (state) % 50 == 0 ? 1000 : static_cast<int>(next_random (state) % 20);
+      reference.push_back ({begin, begin + width, next_id});
+      index.insert (begin, begin + width, next_id++);
+    }
+    else
+    {
+      auto at = next_random (state) % reference.size();
+      assert (index.erase (reference[at].begin, reference[at].id));
+      assert (!index.erase (reference[at].begin, reference[at].id));
+      reference.erase (reference.begin() + at);
+    }
+    assert (index.size() == reference.size());
+
+    // a query reports exactly the overlapping intervals, nothing else
+    int begin = static_cast<int>(next_random (state) % 1000);
+    int end = begin + static_cast<int>(next_random (state) % 30);
+    std::vector<std::size_t> expected, found;
+    for (auto&& e : reference)
+      if (e.begin < end && begin < e.end)
+        expected.push_back (e.id);
+    index.for_each_overlap (begin, end, [&] (std::size_t id) { found.push_back (id); return true; });
+    std::sort (expected.begin(), expected.end());
+    std::sort (found.begin(), found.end());
+    assert (found == expected);
+
+    // lookup by begin also finds empty intervals
+    auto const& some = reference[next_random (state) % reference.size()];
+    bool seen = false;
+    index.for_each_at (some.begin, [&] (std::size_t id) { seen = seen || id == some.id; return !seen; });
+    assert (seen);
+  }
+
+  // stops when asked to
+  index.clear();
+  for (std::size_t i = 0; i != 10; ++i)
+    index.insert (0, 100, i);
+  std::size_t calls = 0;
+  assert (!index.for_each_overlap (10, 20, [&] (std::size_t) { return ++calls != 3; }));
+  assert (calls == 3);
+
+  std::cout << "interval index finds overlaps" << std::endl;
+  return 0;
+}
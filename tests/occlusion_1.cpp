@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/occlusion.hpp>
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+bool contains (rectangle const& r, int x, int y)
+{
+  return r.i0.first <= x && x < r.i0.second && r.i1.first <= y && y < r.i1.second;
+}
+
+int main()
+{
+  // a window over a background, a tooltip over the window
+  {
+    std::vector<rectangle> rects {{{0, 100}, {0, 100}}, {{10, 50}, {10, 50}}, {{40, 60}, {40, 60}}};
+    std::vector<int> z {0, 1, 2};
+    auto visible = exp::algorithm::occlusion_partition (rects, z);
+    assert (visible.size() == 3);
+    assert (visible.of (2).size() == 1 && visible.of (2)[0] == rects[2]);
+    int area[3] = {};
+    for (std::size_t i = 0; i != 3; ++i)
+      for (auto&& f : visible.of (i))
+        area[i] += (f.i0.second - f.i0.first) * (f.i1.second - f.i1.first);
+    assert (area[2] == 400 && area[1] == 1600 - 100 && area[0] == 10000 - 1600 - 300);
+  }
+
+  // covered entirely, the same depth keeps the first one, empty inputs
+  // have no fragments
+  {
+    std::vector<rectangle> rects {{{0, 10}, {0, 10}}, {{2, 4}, {2, 4}}, {{0, 10}, {0, 10}}, {{5, 5}, {0, 10}}};
+    std::vector<int> z {1, 0, 1, 2};
+    auto visible = exp::algorithm::occlusion_partition (rects, z);
+    assert (visible.of (0).size() == 1 && visible.of (0)[0] == rects[0]);
+    assert (visible.of (1).empty() && visible.of (2).empty() && visible.of (3).empty());
+  }
+
+  // every covered point is in one fragment, of the topmost input there
+  unsigned state = 17;
+  for (int round = 0; round != 20; ++round)
+  {
+    std::vector<rectangle> rects;
+    std::vector<unsigned> z;
+    for (int i = 0; i != 60; ++i)
+    {
+      int x = static_cast<int>(next_random (state) % 50), y = static_cast<int>(next_random (state) % 50);
+      rects.push_back ({{x, x + static_cast<int>(next_random (state) % 20)}, {y, y + static_cast<int>(next_random (state) % 20)}});
+      z.push_back (next_random (state) % 8);
+    }
+    // half the rounds have a full width bar over everything
+    if (round % 2)
+    {
+      rects.push_back ({{0, 70}, {20, 30}});
+      z.push_back (8);
+    }
+    auto visible = exp::algorithm::occlusion_partition (rects, z);
+    assert (visible.size() == rects.size());
+    for (std::size_t i = 0; i != rects.size(); ++i)
+      for (auto&& f : visible.of (i))
+        assert (f.i0.first < f.i0.second && f.i1.first < f.i1.second
+                && rects[i].i0.first <= f.i0.first && f.i0.second <= rects[i].i0.second
+                && rects[i].i1.first <= f.i1.first && f.i1.second <= rects[i].i1.second);
+
+    for (int x = 0; x != 70; ++x)
+      for (int y = 0; y != 70; ++y)
+      {
+        std::size_t top = rects.size();
+        for (std::size_t i = 0; i != rects.size(); ++i)
+          if (contains (rects[i], x, y) && (top == rects.size() || z[top] < z[i]))
+            top = i;
+        std::size_t hits = 0;
+        for (std::size_t i = 0; i != rects.size(); ++i)
+          for (auto&& f : visible.of (i))
+            if (contains (f, x, y))
+            {
+              ++hits;
+              assert (i == top);
+            }
+        assert (hits == (top == rects.size() ? 0 : 1));
+      }
+  }
+
+  std::cout << "occlusion partition keeps the visible parts" << std::endl;
+  return 0;
+}
@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/overlap_filter.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+using support::next_random;
+
+// every kernel the CPU runs gives the masks of rectangles_overlap
+template <typename Position>
+void check_kernels (Position offset)
+{
+  typedef std::pair<Position, Position> interval;
+  typedef exp::algorithm::rectangle<interval, interval> rectangle;
+  using exp::algorithm::simd_level;
+
+  unsigned state = 5;
+  for (int round = 0; round != 60; ++round)
+  {
+    std::vector<rectangle> rects (next_random (state) % 300);
+    auto coordinate = [&] { return static_cast<Position>(next_random (state) % 64) + offset; };
+    exp::algorithm::soa_rectangles<Position> soa;
+    for (auto&& r : rects)
+    {
+      auto x1 = coordinate (), x2 = coordinate (), y1 = coordinate (), y2 = coordinate ();
+      r = {{std::min (x1, x2), std::max (x1, x2)}, {std::min (y1, y2), std::max (y1, y2)}};
+      soa.push_back (r);
+    }
+    rectangle query {{coordinate (), coordinate ()}, {coordinate (), coordinate ()}};
+    if (query.i0.second < query.i0.first)
+      std::swap (query.i0.first, query.i0.second);
+    if (query.i1.second < query.i1.first)
+      std::swap (query.i1.first, query.i1.second);
+
+    std::vector<std::uint64_t> expected ((rects.size() + 63) / 64);
+    for (std::size_t i = 0; i != rects.size(); ++i)
+      if (exp::algorithm::detail::rectangles_overlap (rects[i], query))
+        expected[i / 64] |= std::uint64_t (1) << (i % 64);
+
+    for (auto level : {simd_level::scalar, simd_level::sse4_2, simd_level::avx2, simd_level::avx512})
+    {
+      if (exp::algorithm::detected_simd_level() < level)
+        break;
+      std::vector<std::uint64_t> masks;
+      exp::algorithm::overlap_masks (soa, query, masks, level);
+      assert (masks == expected);
+    }
+
+    std::vector<std::size_t> found;
+    std::vector<std::uint64_t> scratch;
+    exp::algorithm::for_each_overlap (soa, query, scratch, [&] (std::size_t i) { found.push_back (i); });
+    for (std::size_t i = 0, f = 0; i != rects.size(); ++i)
+      if (expected[i / 64] >> (i % 64) & 1)
+        assert (found[f++] == i);
+  }
+}
+
+int main()
+{
+  // negative, unsigned with the top bit set and 64 bit positions
+  check_kernels<int> (-32);
+  check_kernels<unsigned> (0x7fffffe0u);
+  check_kernels<long long> (-(1ll << 40));
+  check_kernels<unsigned long long> (0x7fffffffffffffe0ull);
+  check_kernels<short> (-32);
+  check_kernels<double> (0.5);
+
+  // insertions and erasures keep the mirror in step with open_0
+  typedef std::pair<int, int> interval;
+  typedef exp::algorithm::rectangle<interval, interval> rectangle;
+  typedef exp::algorithm::event<exp::algorithm::detail::interval_n<rectangle, 0>> event;
+  exp::algorithm::detail::open_set<event> open;
+  unsigned state = 9;
+  std::vector<rectangle> inserted;
+  std::vector<exp::algorithm::detail::open_set<event>::handle_type> handles;
+  for (int i = 0; i != 500; ++i)
+  {
+    if (inserted.empty() || next_random (state) % 3 != 0)
+    {
+      int x = static_cast<int>(next_random (state) % 100), y = static_cast<int>(next_random (state) % 100);
+      rectangle r {{x, x + 1 + static_cast<int>(next_random (state) % 10)}, {y, y + 1}};
+      handles.push_back (open.insert ({exp::algorithm::event_type::begin, {r}}));
+      inserted.push_back (r);
+    }
+    else
+    {
+      auto at = next_random (state) % inserted.size();
+      assert (open.events[open.slots[handles[at]]].interval.rectangle == inserted[at]);
+      exp::algorithm::detail::erase_rectangle (open, handles[at]);
+      inserted.erase (inserted.begin() + at);
+      handles.erase (handles.begin() + at);
+    }
+    assert (open.coordinates.size() == open.events.size());
+    assert (open.size() == inserted.size());
+    // erased slots stay behind until they are compacted, and no query
+    // overlaps them
+    std::vector<std::uint64_t> masks;
+    exp::algorithm::overlap_masks (open.coordinates, rectangle {{-1000, 1000}, {-1000, 1000}}, masks);
+    for (std::size_t j = 0; j != open.events.size(); ++j)
+    {
+      bool erased = open.handles[j] == open.no_handle;
+      assert (erased == !(masks[j / 64] >> (j % 64) & 1));
+      if (!erased)
+      {
+        assert (open.coordinates.x1()[j] == open.events[j].interval.rectangle.i0.first
+                && open.coordinates.y2()[j] == open.events[j].interval.rectangle.i1.second);
+        assert (open.slots[open.handles[j]] == j);
+      }
+    }
+  }
+
+  std::cout << "overlap kernels agree with rectangles_overlap" << std::endl;
+  return 0;
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/packed_rectangle.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <limits>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+template <typename T>
+rectangle unpacked (exp::algorithm::packed_rectangle<T> const& r)
+{
+  return {{r.i0.begin, r.i0.end}, {r.i1.begin, r.i1.end}};
+}
+
+// the word predicates agree with the generic ones on rectangles of int
+// pairs, around the extremes and the sign bit of the lanes too
+template <typename T>
+void check_predicates ()
+{
+  typedef exp::algorithm::packed_rectangle<T> packed;
+  static_assert (sizeof (packed) == 8, "four 16 bit positions");
+  int const bases[] = {std::numeric_limits<T>::min(), -1, 0, 0x7fff - 8, 0x8000 - 8, std::numeric_limits<T>::max() - 16};
+  unsigned state = 5;
+  for (int round = 0; round != 200000; ++round)
+  {
+    int base = bases[next_random (state) % 6];
+    if (base < std::numeric_limits<T>::min() || std::numeric_limits<T>::max() - 16 < base)
+      continue;
+    auto position = [&] { return static_cast<T>(base + static_cast<int>(next_random (state) % 17)); };
+    auto make = [&]
+                {
+                  T x1 = position (), x2 = position (), y1 = position (), y2 = position ();
+                  return packed {{std::min (x1, x2), std::max (x1, x2)}, {std::min (y1, y2), std::max (y1, y2)}};
+                };
+    packed l = make (), r = make ();
+    bool overlap = exp::algorithm::detail::rectangles_overlap (unpacked (l), unpacked (r));
+    assert (exp::algorithm::detail::rectangles_overlap (l, r) == overlap);
+    if (overlap)
+    {
+      assert (exp::algorithm::detail::split_code (l, r) == exp::algorithm::detail::split_code (unpacked (l), unpacked (r)));
+      auto fragments = exp::algorithm::split_rectangle (l, r);
+      auto expected = exp::algorithm::split_rectangle (unpacked (l), unpacked (r));
+      assert (fragments.size() == expected.size());
+      for (std::size_t i = 0; i != fragments.size(); ++i)
+        assert (unpacked (fragments[i]) == expected[i]);
+    }
+  }
+}
+
+int main()
+{
+  check_predicates<std::uint16_t>();
+  check_predicates<std::int16_t>();
+
+  // a partition of screen rectangles gives the fragments of int pairs
+  typedef exp::algorithm::packed_rectangle<> packed;
+  unsigned state = 3;
+  std::vector<packed> rects (3000);
+  std::vector<rectangle> wide;
+  for (auto&& r : rects)
+  {
+    auto x = static_cast<std::uint16_t>(next_random (state) % 1900), y = static_cast<std::uint16_t>(next_random (state) % 1060);
+    r = {{x, static_cast<std::uint16_t>(x + 1 + next_random (state) % 20)}
+         , {y, static_cast<std::uint16_t>(y + 1 + next_random (state) % 20)}};
+    wide.push_back (unpacked (r));
+  }
+  auto fragments = exp::algorithm::rectangle_partition (rects);
+  auto expected = exp::algorithm::rectangle_partition (wide);
+  assert (fragments.size() == expected.size());
+  for (std::size_t i = 0; i != fragments.size(); ++i)
+    assert (unpacked (fragments[i]) == expected[i]);
+
+  std::cout << fragments.size() << " packed fragments in " << sizeof (packed) * fragments.size() << " bytes" << std::endl;
+  return 0;
+}
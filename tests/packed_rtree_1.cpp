@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/packed_rtree.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+bool contains (rectangle const& r, int x, int y)
+{
+  return r.i0.first <= x && x < r.i0.second && r.i1.first <= y && y < r.i1.second;
+}
+
+template <std::size_t Fanout>
+void check (std::vector<rectangle> const& fragments, unsigned& state)
+{
+  exp::algorithm::packed_rtree<rectangle, Fanout> index (fragments);
+  assert (index.size() == fragments.size());
+  auto stored = index.fragments();
+  std::vector<rectangle> sorted (stored.begin(), stored.end()), expected = fragments;
+  std::sort (sorted.begin(), sorted.end());
+  std::sort (expected.begin(), expected.end());
+  assert (sorted == expected);
+
+  for (int i = 0; i != 300; ++i)
+  {
+    int x = static_cast<int>(next_random (state) % 1100) - 50, y = static_cast<int>(next_random (state) % 1100) - 50;
+    auto found = index.locate (x, y);
+    auto brute = std::find_if (stored.begin(), stored.end(), [&] (auto&& r) { return contains (r, x, y); });
+    assert (found == static_cast<std::size_t>(brute - stored.begin()));
+
+    rectangle query {{x, x + 1 + static_cast<int>(next_random (state) % 200)}, {y, y + 1 + static_cast<int>(next_random (state) % 200)}};
+    std::vector<std::size_t> hits, brute_hits;
+    index.for_each_intersection (query, [&] (std::size_t h) { hits.push_back (h); });
+    for (std::size_t j = 0; j != stored.size(); ++j)
+      if (exp::algorithm::detail::rectangles_overlap (stored[j], query))
+        brute_hits.push_back (j);
+    std::sort (hits.begin(), hits.end());
+    assert (hits == brute_hits);
+  }
+}
+
+int main()
+{
+  unsigned state = 23;
+
+  // empty and single rectangle indexes
+  exp::algorithm::packed_rtree<rectangle> empty;
+  assert (empty.empty() && empty.locate (0, 0) == 0);
+  exp::algorithm::packed_rtree<rectangle> one (std::vector<rectangle> {{{0, 10}, {0, 10}}});
+  assert (one.locate (5, 5) == 0 && one.locate (10, 5) == 1 && one.locate (0, 0) == 0);
+
+  for (std::size_t n : {1, 2, 15, 16, 17, 300, 3000})
+  {
+    std::vector<rectangle> rects (n);
+    for (auto&& r : rects)
+    {
+      int x = static_cast<int>(next_random (state) % 1000), y = static_cast<int>(next_random (state) % 1000);
+      r = {{x, x + 1 + static_cast<int>(next_random (state) % 80)}, {y, y + 1 + static_cast<int>(next_random (state) % 80)}};
+    }
+    auto fragments = exp::algorithm::rectangle_partition (rects);
+    check<16> (fragments, state);
+    check<2> (fragments, state);
+    check<5> (fragments, state);
+  }
+
+  std::cout << "packed R-tree queries agree with a linear scan" << std::endl;
+  return 0;
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/parallel_partition.hpp>
+
+#include <set>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+int main()
+{
+  unsigned state = 9;
+  int const size = 64;
+  for (int round = 0; round != 100; ++round)
+  {
+    std::vector<rectangle> original (1 + next_random (state) % 60);
+    auto coordinate = [&] { return static_cast<int>(next_random (state) % (size + 1)); };
+    for (auto&& r : original)
+    {
+      auto x1 = coordinate (), x2 = coordinate ()
+        , y1 = coordinate (), y2 = coordinate ();
+      r = {{std::min (x1, x2), std::max (x1, x2)}, {std::min (y1, y2), std::max (y1, y2)}};
+    }
+
+    // the same output whatever the number of threads
+    auto rects = exp::algorithm::parallel_rectangle_partition (original, 1, 6);
+    support::check_partition (original, rects, size);
+    for (std::size_t threads : {2, 3, 8})
+      assert (exp::algorithm::parallel_rectangle_partition (original, threads, 6) == rects);
+    // a multiset input is visited in its own order
+    std::multiset<rectangle> input (original.begin(), original.end());
+    auto set = exp::algorithm::parallel_rectangle_partition (input, 4, 6);
+    auto sorted = exp::algorithm::parallel_rectangle_partition (std::vector<rectangle> (input.begin(), input.end()), 1, 6);
+    assert (set == std::multiset<rectangle> (sorted.begin(), sorted.end()));
+  }
+
+  // a rectangle cut by every border comes back whole
+  std::vector<rectangle> tall {{{0, 8}, {0, 64}}, {{0, 8}, {8, 9}}, {{0, 8}, {20, 21}}, {{0, 8}, {40, 41}}};
+  auto whole = exp::algorithm::parallel_rectangle_partition (tall, 4, 4);
+  assert (whole.size() == 1 && whole[0] == tall[0]);
+
+  // large enough for the default number of bands
+  std::vector<rectangle> tiles;
+  for (int x = 0; x != 16 * 128; x += 16)
+    for (int y = 0; y != 16 * 128; y += 16)
+      tiles.push_back ({{x, x + 16}, {y, y + 16}});
+  for (int i = 0; i != 200; ++i)
+  {
+    int x = next_random (state) % (16 * 120), y = next_random (state) % (16 * 120);
+    tiles.push_back ({{x, x + 1 + static_cast<int>(next_random (state) % 100)}
+                      , {y, y + 1 + static_cast<int>(next_random (state) % 100)}});
+  }
+  auto parallel = exp::algorithm::parallel_rectangle_partition (tiles, 4);
+  assert (parallel == exp::algorithm::parallel_rectangle_partition (tiles, 1));
+  long covered = 0;
+  for (auto&& r : parallel)
+    covered += long (r.i0.second - r.i0.first) * (r.i1.second - r.i1.first);
+  assert (covered == 16l * 128 * 16 * 128);
+
+  std::cout << "partitioned " << tiles.size() << " rectangles into " << parallel.size() << " in "
+            << exp::algorithm::detail::default_band_count (tiles.size()) << " bands" << std::endl;
+  return 0;
+}
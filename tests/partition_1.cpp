@@ -11,12 +11,13 @@
 #include <set>
 #include <vector>
 #include <iostream>
+#include <cassert>
 
 int main()
 {
   typedef std::pair<int, int> interval;
   typedef exp::algorithm::rectangle<interval, interval> rectangle;
-  std::vector<rectangle> rects
+  std::vector<rectangle> original
         {
            { { 0,  10}, { 0,  35}}
          , { { 0,   5}, { 20,  30}}
@@ -24,10 +25,28 @@ int main()
          , { { 0,  20}, { 30 , 50}}
          , { { 5,  20}, { 20,  35}}};
   
-  rects = exp::algorithm::rectangle_partition (rects);
+  auto rects = exp::algorithm::rectangle_partition (original);
   std::cout << "new rectangles" << std::endl;
   for (auto&& r : rects)
     std::cout << "r: " << r << std::endl;
 
-  return -1;
+  // every unit cell must be covered by exactly one new rectangle if,
+  // and only if, it is covered by some original rectangle
+  for (int x = 0; x != 30; ++x)
+    for (int y = 0; y != 50; ++y)
+    {
+      auto covers = [x, y] (rectangle const& r)
+                    { return r.i0.first <= x && x < r.i0.second && r.i1.first <= y && y < r.i1.second; };
+      auto before = std::count_if (original.begin(), original.end(), covers);
+      auto after = std::count_if (rects.begin(), rects.end(), covers);
+      assert (after == (before ? 1 : 0));
+    }
+
+  std::set<rectangle> set_rects (original.begin(), original.end());
+  set_rects = exp::algorithm::rectangle_partition (set_rects);
+  assert (set_rects.size() == rects.size());
+  for (auto&& r : rects)
+    assert (set_rects.find (r) != set_rects.end());
+
+  return 0;
 }
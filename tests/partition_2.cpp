@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+
+#include <set>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+long area (rectangle const& r)
+{
+  return long(r.i0.second - r.i0.first) * (r.i1.second - r.i1.first);
+}
+
+using support::next_random;
+
+int main()
+{
+  unsigned state = 42;
+  int const size = 64;
+  for (int round = 0; round != 200; ++round)
+  {
+    std::vector<rectangle> original (1 + next_random (state) % 40);
+    auto coordinate = [&] { return static_cast<int>(next_random (state) % (size + 1)); };
+    for (auto&& r : original)
+    {
+      auto x1 = coordinate (), x2 = coordinate ()
+        , y1 = coordinate (), y2 = coordinate ();
+      r = {{std::min (x1, x2), std::max (x1, x2)}, {std::min (y1, y2), std::max (y1, y2)}};
+    }
+    // some duplicates and shared borders
+    original.push_back (original.front());
+    original.push_back ({original.front().i0, {original.front().i1.second, size}});
+
+    auto rects = exp::algorithm::rectangle_partition (original);
+    support::check_partition (original, rects, size);
+  }
+
+  // a tile grid covered by one rectangle and a few on top of it
+  std::vector<rectangle> tiles;
+  for (int x = 0; x != size; x += 8)
+    for (int y = 0; y != size; y += 8)
+      tiles.push_back ({{x, x + 8}, {y, y + 8}});
+  tiles.push_back ({{4, 60}, {4, 60}});
+  tiles.push_back ({{0, size}, {0, size}});
+  auto rects = exp::algorithm::rectangle_partition (tiles);
+  support::check_partition (tiles, rects, size);
+  long total = 0;
+  for (auto&& r : rects)
+    total += area (r);
+  assert (total == size * size);
+  std::cout << "tiles partitioned in " << rects.size() << " rectangles" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/allocation_counter.hpp"
+#include "../support/test_support.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+
+#include <memory_resource>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+// counts what goes through it, on top of std::allocator
+template <typename T>
+struct counting_allocator
+{
+  typedef T value_type;
+
+  explicit counting_allocator (std::size_t* count) : count (count) {}
+  template <typename U>
+  counting_allocator (counting_allocator<U> const& other) : count (other.count) {}
+
+  T* allocate (std::size_t n)
+  {
+    ++*count;
+    return std::allocator<T>().allocate (n);
+  }
+  void deallocate (T* p, std::size_t n) { std::allocator<T>().deallocate (p, n); }
+
+  template <typename U>
+  bool operator==(counting_allocator<U> const& other) const { return count == other.count; }
+  template <typename U>
+  bool operator!=(counting_allocator<U> const& other) const { return count != other.count; }
+
+  std::size_t* count;
+};
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+int main()
+{
+  unsigned state = 29;
+  std::vector<rectangle> rects (2000);
+  for (auto&& r : rects)
+  {
+    int x = static_cast<int>(next_random (state) % 1000), y = static_cast<int>(next_random (state) % 1000);
+    r = {{x, x + 1 + static_cast<int>(next_random (state) % 60)}, {y, y + 1 + static_cast<int>(next_random (state) % 60)}};
+  }
+  auto expected = exp::algorithm::rectangle_partition (rects);
+
+  std::size_t count = 0;
+  auto counted = exp::algorithm::rectangle_partition (std::allocator_arg, counting_allocator<char> (&count), rects);
+  assert (counted == expected);
+  assert (count != 0);
+
+  // with a buffer big enough, the sweep never reaches the global heap.
+  // The input is moved in, a copy of a pmr container would take the
+  // default resource.
+  std::vector<char> buffer (64 << 20);
+  std::pmr::monotonic_buffer_resource resource (buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+  std::pmr::vector<rectangle> input (rects.begin(), rects.end(), &resource);
+  for (int frame = 0; frame != 3; ++frame)
+  {
+    auto before = support::allocations().allocations;
+    auto fragments = exp::algorithm::rectangle_partition
+      (std::allocator_arg, std::pmr::polymorphic_allocator<char> (&resource), std::move (input));
+    assert (support::allocations().allocations == before);
+    assert (std::equal (fragments.begin(), fragments.end(), expected.begin(), expected.end()));
+    resource.release ();
+    input = std::pmr::vector<rectangle> (rects.begin(), rects.end(), &resource);
+  }
+
+  std::cout << "the partition sweep allocates through the given allocator" << std::endl;
+  return 0;
+}
@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/allocation_counter.hpp"
+#include "../support/test_support.hpp"
+
+#include <algorithm/partition_cache.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <new>
+#include <deque>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+std::vector<rectangle> make_rectangles (unsigned state, std::size_t n)
+{
+  std::vector<rectangle> rects (n);
+  for (auto&& r : rects)
+  {
+    int x = static_cast<int>(next_random (state) % 300), y = static_cast<int>(next_random (state) % 300);
+    r = {{x, x + 1 + static_cast<int>(next_random (state) % 40)}, {y, y + 1 + static_cast<int>(next_random (state) % 40)}};
+  }
+  return rects;
+}
+
+int main()
+{
+  exp::algorithm::partition_cache<rectangle> cache (2);
+  auto a = make_rectangles (1, 200), b = make_rectangles (2, 200), c = make_rectangles (3, 50);
+
+  // a miss partitions the sorted set
+  auto sorted_a = a;
+  std::sort (sorted_a.begin(), sorted_a.end());
+  auto expected_a = exp::algorithm::rectangle_partition (sorted_a);
+  assert (cache.partition (a) == expected_a);
+  assert (cache.hits() == 0 && cache.misses() == 1 && cache.size() == 1);
+
+  // the same set in another order and another container is a hit with
+  // the same fragments
+  auto shuffled = a;
+  unsigned state = 11;
+  for (std::size_t i = shuffled.size(); i > 1; --i)
+    std::swap (shuffled[i - 1], shuffled[next_random (state) % i]);
+  assert (shuffled != a);
+  assert (exp::algorithm::fingerprint_rectangles (shuffled) == exp::algorithm::fingerprint_rectangles (a));
+  assert (exp::algorithm::rectangle_partition (cache, shuffled) == expected_a);
+  assert (cache.partition (std::deque<rectangle> (a.begin(), a.end())) == expected_a);
+  assert (cache.hits() == 2 && cache.misses() == 1);
+
+  // a rectangle more, even a duplicate, or one moved is another set
+  auto duplicated = a;
+  duplicated.push_back (a[0]);
+  assert (exp::algorithm::fingerprint_rectangles (duplicated) != exp::algorithm::fingerprint_rectangles (a));
+  auto moved = a;
+  ++moved[7].i0.second;
+  assert (exp::algorithm::fingerprint_rectangles (moved) != exp::algorithm::fingerprint_rectangles (a));
+  assert (exp::algorithm::fingerprint_rectangles (std::vector<rectangle>())
+          != exp::algorithm::fingerprint_rectangles (std::vector<rectangle> {rectangle {{0, 0}, {0, 0}}}));
+
+  // the set used least recently is evicted: b, then a is used, so c
+  // evicts b
+  auto sorted_b = b;
+  std::sort (sorted_b.begin(), sorted_b.end());
+  assert (cache.partition (b) == exp::algorithm::rectangle_partition (sorted_b));
+  assert (cache.partition (a) == expected_a);
+  assert (cache.size() == 2 && cache.hits() == 3 && cache.misses() == 2);
+  cache.partition (c);
+  assert (cache.size() == 2 && cache.misses() == 3);
+  cache.partition (a);
+  assert (cache.hits() == 4);
+  cache.partition (b);
+  assert (cache.misses() == 4);
+  cache.partition (c);
+  assert (cache.misses() == 5);
+
+  // the empty set is a set too
+  assert (cache.partition (std::vector<rectangle>()).empty());
+  cache.clear();
+  assert (cache.size() == 0);
+  assert (cache.partition (a) == expected_a);
+  assert (cache.misses() == 7);
+
+  // a miss that throws, wherever it does, leaves the cache as it was
+  exp::algorithm::partition_cache<rectangle> failing (2);
+  auto expected_b = exp::algorithm::rectangle_partition (sorted_b);
+  failing.partition (a);
+  failing.partition (b);
+  std::size_t failures = 0;
+  for (std::size_t k = 1;; ++k)
+  {
+    support::allocations().failing_in = k;
+    try
+    {
+      failing.partition (c);
+    }
+    catch (std::bad_alloc const&)
+    {
+      ++failures;
+      auto hits = failing.hits();
+      assert (failing.size() == 2);
+      assert (failing.partition (a) == expected_a && failing.partition (b) == expected_b);
+      assert (failing.hits() == hits + 2);
+      continue;
+    }
+    support::allocations().failing_in = 0;
+    break;
+  }
+  assert (failures != 0);
+  // c evicted a, b is still there
+  auto hits = failing.hits();
+  assert (failing.partition (b) == expected_b && failing.hits() == hits + 1);
+  assert (failing.partition (a) == expected_a && failing.hits() == hits + 1);
+
+  std::cout << "partition cache: " << cache.hits() << " hits, " << cache.misses() << " misses" << std::endl;
+  return 0;
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/allocation_counter.hpp"
+#include "../support/test_support.hpp"
+
+#include <algorithm/rectangles_partition.hpp>
+
+#include <set>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+std::vector<rectangle> random_rectangles (unsigned seed, std::size_t n)
+{
+  std::vector<rectangle> rects (n);
+  for (auto&& r : rects)
+  {
+    int x = static_cast<int>(next_random (seed) % 1000), y = static_cast<int>(next_random (seed) % 1000);
+    r = {{x, x + 1 + static_cast<int>(next_random (seed) % 60)}, {y, y + 1 + static_cast<int>(next_random (seed) % 60)}};
+  }
+  return rects;
+}
+
+int main()
+{
+  exp::algorithm::partition_workspace<rectangle> workspace;
+  std::vector<rectangle> fragments;
+
+  // the first call grows everything, the same input again allocates nothing
+  auto rects = random_rectangles (7, 3000);
+  exp::algorithm::rectangle_partition (workspace, rects, fragments);
+  assert (fragments == exp::algorithm::rectangle_partition (rects));
+  for (int frame = 0; frame != 3; ++frame)
+  {
+    auto before = support::allocations().allocations;
+    exp::algorithm::rectangle_partition (workspace, rects, fragments);
+    assert (support::allocations().allocations == before);
+  }
+  assert (fragments == exp::algorithm::rectangle_partition (rects));
+
+  // smaller inputs fit in what is already there
+  for (unsigned seed = 1; seed != 6; ++seed)
+  {
+    auto frame = random_rectangles (seed, 1000);
+    auto expected = exp::algorithm::rectangle_partition (frame);
+    auto before = support::allocations().allocations;
+    exp::algorithm::rectangle_partition (workspace, frame, fragments);
+    assert (support::allocations().allocations == before);
+    assert (fragments == expected);
+  }
+
+  // a larger one grows the workspace, and the output may be a set
+  auto large = random_rectangles (11, 6000);
+  std::set<rectangle> set_fragments;
+  exp::algorithm::rectangle_partition (workspace, large, set_fragments);
+  auto expected = exp::algorithm::rectangle_partition (large);
+  assert (set_fragments == std::set<rectangle> (expected.begin(), expected.end()));
+
+  // empty input leaves no fragments
+  exp::algorithm::rectangle_partition (workspace, std::vector<rectangle>{}, fragments);
+  assert (fragments.empty());
+
+  std::cout << "a warm partition workspace does not allocate" << std::endl;
+  return 0;
+}
@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/rectangle_format.hpp>
+#include <algorithm/rectangles_partition.hpp>
+
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+using support::next_random;
+
+template <typename Rectangle>
+std::vector<Rectangle> sorted (std::vector<Rectangle> rects)
+{
+  std::sort (rects.begin(), rects.end()
+             , [] (Rectangle const& l, Rectangle const& r)
+               {
+                 return std::make_tuple (l.i0.first, l.i1.first, l.i0.second, l.i1.second)
+                   < std::make_tuple (r.i0.first, r.i1.first, r.i0.second, r.i1.second);
+               });
+  return rects;
+}
+
+template <typename Rectangle>
+bool throws_format_error (std::vector<unsigned char> const& bytes)
+{
+  try
+  {
+    std::vector<Rectangle> out;
+    exp::algorithm::decode_rectangles (bytes.data(), bytes.size(), out);
+  }
+  catch (exp::algorithm::format_error const&)
+  {
+    return true;
+  }
+  return false;
+}
+
+// every value of the coordinate type round trips, the extremes too
+template <typename Position>
+void check_round_trip ()
+{
+  typedef std::pair<Position, Position> interval;
+  typedef exp::algorithm::rectangle<interval, interval> rectangle;
+  Position const values[] = {std::numeric_limits<Position>::min(), std::numeric_limits<Position>::max()
+                             , Position (0), Position (1), Position (100), Position (127), Position (128)};
+  unsigned state = 3;
+  for (std::size_t n : {0, 1, 2, 500})
+  {
+    std::vector<rectangle> rects (n);
+    for (auto&& r : rects)
+    {
+      auto coordinate = [&] { return static_cast<Position>(static_cast<unsigned long long>(values[next_random (state) % 7]) + next_random (state) % 3); };
+      r = {{coordinate (), coordinate ()}, {coordinate (), coordinate ()}};
+    }
+    std::vector<unsigned char> bytes;
+    exp::algorithm::encode_rectangles (rects, bytes);
+    std::vector<rectangle> decoded;
+    exp::algorithm::decode_rectangles (bytes.data(), bytes.size(), decoded);
+    assert (decoded == sorted (rects));
+  }
+}
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+typedef exp::algorithm::rectangle<std::pair<short, short>, std::pair<short, short>> short_rectangle;
+
+int main()
+{
+
+  check_round_trip<int>();
+  check_round_trip<unsigned>();
+  check_round_trip<long long>();
+  check_round_trip<unsigned long long>();
+  check_round_trip<short>();
+  check_round_trip<unsigned char>();
+
+  // a partition of rectangles that overlap, and its fragments
+  unsigned state = 7;
+  std::vector<rectangle> rects (2000);
+  for (auto&& r : rects)
+  {
+    int x = static_cast<int>(next_random (state) % 2000) - 1000, y = static_cast<int>(next_random (state) % 2000) - 1000;
+    r = {{x, x + 1 + static_cast<int>(next_random (state) % 50)}, {y, y + 1 + static_cast<int>(next_random (state) % 50)}};
+  }
+  auto fragments = exp::algorithm::rectangle_partition (rects);
+  std::vector<unsigned char> bytes;
+  exp::algorithm::encode_rectangles (fragments, bytes);
+  std::size_t const fragment_bytes = bytes.size();
+
+  // into every container rectangle_partition takes
+  std::vector<rectangle> as_vector;
+  exp::algorithm::decode_rectangles (bytes.data(), bytes.size(), as_vector);
+  assert (as_vector == sorted (fragments));
+  std::deque<rectangle> as_deque;
+  exp::algorithm::decode_rectangles (bytes.data(), bytes.size(), as_deque);
+  assert (std::equal (as_deque.begin(), as_deque.end(), as_vector.begin(), as_vector.end()));
+  std::multiset<rectangle> as_set;
+  exp::algorithm::decode_rectangles (bytes.data(), bytes.size(), as_set);
+  assert (as_set == std::multiset<rectangle> (fragments.begin(), fragments.end()));
+  assert (sorted (exp::algorithm::rectangle_partition (as_vector)) == as_vector);
+
+  // sets one after another in a stream
+  std::stringstream stream;
+  exp::algorithm::write_rectangles (stream, rects);
+  exp::algorithm::write_rectangles (stream, fragments);
+  exp::algorithm::write_rectangles (stream, std::vector<rectangle>());
+  std::vector<rectangle> read;
+  exp::algorithm::read_rectangles (stream, read);
+  assert (read == sorted (rects));
+  exp::algorithm::read_rectangles (stream, read);
+  assert (read == as_vector);
+  exp::algorithm::read_rectangles (stream, read);
+  assert (read.empty());
+  stream.peek();
+  assert (stream.eof());
+
+  // the mapped reader iterates the file as it is
+  auto path = std::filesystem::temp_directory_path().string() + "/rectangle_format_1.rset";
+  {
+    std::ofstream file (path, std::ios::binary);
+    exp::algorithm::write_rectangles (file, fragments);
+  }
+  {
+    exp::algorithm::mapped_rectangle_set<rectangle> mapped (path.c_str());
+    assert (mapped.size() == fragments.size());
+    assert (std::equal (mapped.begin(), mapped.end(), as_vector.begin(), as_vector.end()));
+  }
+  std::filesystem::remove (path);
+
+  // anything malformed throws format_error
+  assert (!throws_format_error<rectangle> (bytes));
+  auto broken = bytes;
+  broken[0] = 'X';
+  assert (throws_format_error<rectangle> (broken));
+  broken = bytes;
+  broken[4] = 2;
+  assert (throws_format_error<rectangle> (broken));
+  assert (throws_format_error<short_rectangle> (bytes));
+  broken.assign (bytes.begin(), bytes.end() - 1);
+  assert (throws_format_error<rectangle> (broken));
+  broken.assign (bytes.begin(), bytes.begin() + 10);
+  assert (throws_format_error<rectangle> (broken));
+  // a count that disagrees with the payload, each way
+  broken = bytes;
+  ++broken[8];
+  assert (throws_format_error<rectangle> (broken));
+  broken = bytes;
+  --broken[8];
+  assert (throws_format_error<rectangle> (broken));
+  broken = bytes;
+  broken.push_back (0);
+  assert (throws_format_error<rectangle> (broken));
+  bool truncated = false;
+  try
+  {
+    std::stringstream cut (std::string (bytes.begin(), bytes.end() - 5));
+    exp::algorithm::read_rectangles (cut, read);
+  }
+  catch (exp::algorithm::format_error const&)
+  {
+    truncated = true;
+  }
+  assert (truncated);
+
+  std::cout << fragments.size() << " fragments in " << fragment_bytes << " bytes, "
+            << sizeof (rectangle) * fragments.size() << " as an array" << std::endl;
+  return 0;
+}
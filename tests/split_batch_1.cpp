@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/interval.hpp>
+#include <algorithm/rectangle.hpp>
+#include <algorithm/split_rectangles.hpp>
+#include <algorithm/split_batch.hpp>
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+using support::next_random;
+
+// split_batch writes the fragments split_rectangle gives, in order,
+// for every disposition including shared borders
+template <typename Position>
+void check_batch (Position offset)
+{
+  typedef std::pair<Position, Position> interval;
+  typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+  unsigned state = 17;
+  exp::algorithm::soa_rectangles<Position> dividends, out;
+  std::vector<unsigned char> codes;
+  for (int round = 0; round != 400; ++round)
+  {
+    // few distinct coordinates, so borders are often shared
+    auto coordinate = [&] { return static_cast<Position>(next_random (state) % 6) + offset; };
+    auto random_rectangle = [&]
+    {
+      auto x1 = coordinate (), y1 = coordinate ();
+      return rectangle {{x1, x1 + 1 + static_cast<Position>(next_random (state) % 4)}
+                        , {y1, y1 + 1 + static_cast<Position>(next_random (state) % 4)}};
+    };
+    std::vector<rectangle> input (next_random (state) % 40);
+    dividends.clear();
+    for (auto&& r : input)
+    {
+      r = random_rectangle ();
+      dividends.push_back (r);
+    }
+    auto divisor = random_rectangle ();
+
+    std::vector<rectangle> expected;
+    std::size_t splits = 0;
+    for (auto&& r : input)
+    {
+      if (exp::algorithm::detail::rectangles_overlap (r, divisor))
+      {
+        exp::algorithm::split_rectangle (r, divisor, std::back_inserter (expected));
+        ++splits;
+      }
+      else
+        expected.push_back (r);
+    }
+
+    std::size_t traced = 0;
+    exp::algorithm::split_batch (dividends, divisor, out, codes
+                                 , [&] (exp::algorithm::trace_point point, rectangle const& piece, rectangle const& by)
+                                   {
+                                     assert (point == exp::algorithm::trace_point::split && by == divisor);
+                                     assert (exp::algorithm::detail::rectangles_overlap (piece, divisor));
+                                     ++traced;
+                                   });
+    assert (out.size() == expected.size() && traced == splits);
+    for (std::size_t i = 0; i != out.size(); ++i)
+      assert ((rectangle {{out.x1()[i], out.x2()[i]}, {out.y1()[i], out.y2()[i]}} == expected[i]));
+  }
+}
+
+int main()
+{
+  check_batch<int> (-3);
+  check_batch<unsigned> (0x7ffffffdu);
+  check_batch<long long> (-(1ll << 40));
+  check_batch<double> (0.25);
+
+  std::cout << "batched splits match split_rectangle" << std::endl;
+  return 0;
+}
@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <algorithm/rectangle.hpp>
+#include <algorithm/split_rectangles.hpp>
+
+#include <vector>
+#include <iterator>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+bool covers (rectangle const& r, int x, int y)
+{
+  return r.i0.first <= x && x < r.i0.second && r.i1.first <= y && y < r.i1.second;
+}
+
+int main()
+{
+  static_assert (sizeof (exp::algorithm::split_result<rectangle>) <= 4 * sizeof (rectangle) + sizeof (void*)
+                 , "split_result is stored inline");
+  int const size = 12;
+  std::size_t splits = 0;
+  bool dispositions[16] = {};
+  // every pair of overlapping rectangles with coordinates in [0, size)
+  // in steps that reach all dispositions
+  for (int ex1 = 0; ex1 < size; ex1 += 3)
+  for (int ex2 = ex1 + 3; ex2 < size; ex2 += 3)
+  for (int ey1 = 0; ey1 < size; ey1 += 3)
+  for (int ey2 = ey1 + 3; ey2 < size; ey2 += 3)
+  for (int ix1 = 0; ix1 < size; ix1 += 2)
+  for (int ix2 = ix1 + 2; ix2 <= size; ix2 += 2)
+  for (int iy1 = 0; iy1 < size; iy1 += 2)
+  for (int iy2 = iy1 + 2; iy2 <= size; iy2 += 2)
+  {
+    rectangle dividend {{ex1, ex2}, {ey1, ey2}}, divisor {{ix1, ix2}, {iy1, iy2}};
+    if (!exp::algorithm::detail::rectangles_overlap (dividend, divisor))
+      continue;
+    ++splits;
+    dispositions[(ix2 >= ex2) << 3 | (iy2 >= ey2) << 2 | (ix1 <= ex1) << 1 | (iy1 <= ey1)] = true;
+
+    auto fragments = exp::algorithm::split_rectangle (dividend, divisor);
+    std::vector<rectangle> written;
+    exp::algorithm::split_rectangle (dividend, divisor, std::back_inserter (written));
+    assert (written.size() == fragments.size());
+    assert (std::equal (written.begin(), written.end(), fragments.begin()));
+
+    // fragments cover exactly the part of dividend outside divisor
+    for (int x = 0; x != size; ++x)
+      for (int y = 0; y != size; ++y)
+      {
+        int count = 0;
+        for (auto&& f : fragments)
+          count += covers (f, x, y);
+        assert (count == (covers (dividend, x, y) && !covers (divisor, x, y) ? 1 : 0));
+      }
+  }
+  assert (std::count (std::begin (dispositions), std::end (dispositions), true) == 16);
+  std::cout << "checked " << splits << " splits" << std::endl;
+  return 0;
+}
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <algorithm/rectangles_partition.hpp>
+#include <algorithm/event_scan.hpp>
+#include <algorithm/sweep_trace.hpp>
+
+#include <set>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+int main()
+{
+  using exp::algorithm::trace_point;
+  {
+    typedef std::pair<int, int> interval;
+    typedef exp::algorithm::event<interval> event;
+    std::multiset<event> set;
+    std::vector<event> actives;
+    std::vector<interval> intervals {{0, 5}, {0, 10}, {20, 30}, {0, 25}};
+    std::copy (intervals.begin(), intervals.end(), exp::algorithm::interval_inserter<event> (set));
+
+    exp::algorithm::ring_buffer_trace<event, 3> trace;
+    exp::algorithm::scan_events (actives, set, nullptr, [] (auto&&, event const&) {}, trace);
+    assert (trace.recorded() == set.size());
+    assert (trace.size() == 3);
+    // last three events handled by the sweep
+    auto last = std::prev (set.end());
+    assert (trace[2].point == trace_point::event && trace[2].subject == *last);
+    assert (trace[1].subject == *std::prev (last));
+    assert (trace[0].subject == *std::prev (last, 2));
+    std::cout << trace;
+  }
+
+  {
+    typedef std::pair<int, int> interval;
+    typedef exp::algorithm::rectangle<interval, interval> rectangle;
+    std::vector<rectangle> rects
+      {
+         { { 0,  10}, { 0,  35}}
+       , { { 0,   5}, { 20,  30}}
+       , { { 5,  20}, { 20,  35}}};
+
+    exp::algorithm::ring_buffer_trace<rectangle, 256> trace;
+    auto partition = exp::algorithm::rectangle_partition (rects, trace);
+    assert (trace.recorded() < 256);
+    std::size_t opens = 0, closes = 0, splits = 0, erases = 0;
+    trace.for_each ([&] (auto const& r)
+                    {
+                      opens += r.point == trace_point::open;
+                      closes += r.point == trace_point::close;
+                      splits += r.point == trace_point::split;
+                      erases += r.point == trace_point::erase;
+                    });
+    assert (opens == partition.size() && closes == partition.size() && erases == partition.size());
+    assert (splits != 0);
+
+    // the default policy gives the same result
+    assert (exp::algorithm::rectangle_partition (rects) == partition);
+
+    exp::algorithm::rectangle_partition (rects, exp::algorithm::ostream_trace{&std::cout});
+  }
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2020 Felipe Magno de Almeida.
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "../support/test_support.hpp"
+
+#include <algorithm/union_measure.hpp>
+#include <algorithm/banded_region.hpp>
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+typedef std::pair<int, int> interval;
+typedef exp::algorithm::rectangle<interval, interval> rectangle;
+
+using support::next_random;
+
+int main()
+{
+  unsigned state = 31;
+  int const size = 40;
+  for (int round = 0; round != 300; ++round)
+  {
+    std::vector<rectangle> rects (next_random (state) % 25);
+    auto coordinate = [&] { return static_cast<int>(next_random (state) % (size + 1)); };
+    for (auto&& r : rects)
+    {
+      auto x1 = coordinate (), x2 = coordinate (), y1 = coordinate (), y2 = coordinate ();
+      r = {{std::min (x1, x2), std::max (x1, x2)}, {std::min (y1, y2), std::max (y1, y2)}};
+    }
+
+    // unit cells, with a border of empty cells around them
+    int const cells = size + 2;
+    std::vector<int> covered (cells * cells);
+    for (auto&& r : rects)
+      for (int x = r.i0.first; x < r.i0.second; ++x)
+        for (int y = r.i1.first; y < r.i1.second; ++y)
+          covered[(x + 1) * cells + y + 1] = 1;
+    long area = 0, perimeter = 0;
+    for (int x = 1; x != cells; ++x)
+      for (int y = 1; y != cells; ++y)
+      {
+        area += covered[x * cells + y];
+        perimeter += covered[x * cells + y] != covered[(x - 1) * cells + y];
+        perimeter += covered[x * cells + y] != covered[x * cells + y - 1];
+      }
+
+    auto measures = exp::algorithm::measure_union (rects);
+    assert (measures.area == area);
+    assert (measures.perimeter == perimeter);
+    assert (measures.fragments == exp::algorithm::make_banded_region (rects).spans().size());
+    assert (exp::algorithm::union_area (rects) == area);
+    assert (exp::algorithm::union_perimeter (rects) == perimeter);
+  }
+
+  // a ring of four rectangles around a hole
+  std::vector<rectangle> ring {{{0, 10}, {0, 2}}, {{0, 10}, {8, 10}}, {{0, 2}, {0, 10}}, {{8, 10}, {0, 10}}};
+  assert (exp::algorithm::union_area (ring) == 100 - 36);
+  assert (exp::algorithm::union_perimeter (ring) == 40 + 24);
+  assert (exp::algorithm::union_fragment_count (ring) == 4);
+  assert (exp::algorithm::union_area (std::vector<rectangle> ()) == 0);
+
+  // bands are compared exactly: one that only moves its span is a new
+  // fragment, one that ends where the same span begins again is not
+  std::vector<rectangle> shifted {{{0, 2}, {0, 1}}, {{1, 3}, {1, 2}}, {{1, 3}, {2, 3}}, {{1, 2}, {1, 3}}};
+  assert (exp::algorithm::union_fragment_count (shifted) == 2);
+  assert (exp::algorithm::union_fragment_count (shifted) == exp::algorithm::make_banded_region (shifted).spans().size());
+
+  std::cout << "union measures match the covered cells" << std::endl;
+  return 0;
+}